@@ -2,6 +2,7 @@
 #include "registry.h"
 #include "parallel_compressor.h"
 #include "advanced_io.h"
+#include "match_length.h"
 
 #include <algorithm>
 #include <chrono>
@@ -301,7 +302,8 @@ int main(int argc, char** argv) {
               << "Data size: " << data_size_kb << " KB\n"
               << "Warmup runs: " << warmup_runs << "\n"
               << "Measurement runs: " << measurement_runs << "\n"
-              << "Threads available: " << std::thread::hardware_concurrency() << "\n\n";
+              << "Threads available: " << std::thread::hardware_concurrency() << "\n"
+              << "Match length kernel: " << match_length_kernel() << "\n\n";
     
     // 获取算法列表
     std::vector<std::string> algorithms;
@@ -1,3 +1,4 @@
+#include "bwt_compressor.h"
 #include "file_io.h"
 #include "registry.h"
 
@@ -141,6 +142,49 @@ void print_result(const BenchResult& r) {
               << '\n';
 }
 
+// BWT 各级别的块大小与每块工作内存峰值，供按可用内存选择级别
+void print_bwt_memory() {
+    const std::vector<std::pair<const char*, CompressionLevel>> levels = {
+        {"fastest", CompressionLevel::Fastest}, {"fast", CompressionLevel::Fast},
+        {"default", CompressionLevel::Default}, {"better", CompressionLevel::Better},
+        {"best", CompressionLevel::Best},
+    };
+
+    std::cout << "\nBWT memory per level (default threads, budget "
+              << BwtCompressor::kDefaultMemoryBudget / (1024 * 1024) << " MB):\n"
+              << std::left << std::setw(10) << "Level"
+              << std::right
+              << std::setw(12) << "Block(KB)"
+              << std::setw(12) << "CmpMem(MB)"
+              << std::setw(12) << "DecMem(MB)"
+              << std::setw(10) << "CmpThr"
+              << std::setw(14) << "CmpTotal(MB)"
+              << std::setw(10) << "DecThr"
+              << std::setw(14) << "DecTotal(MB)"
+              << '\n';
+    for (const auto& [name, level] : levels) {
+        BwtCompressor bwt(level);
+        const BwtMemoryUsage usage = bwt.memory_usage();
+        const std::size_t compress_threads = bwt.thread_count();
+        const std::size_t decompress_threads = bwt.thread_count(usage.decompress);
+        std::cout << std::left << std::setw(10) << name
+                  << std::right
+                  << std::setw(12) << std::fixed << std::setprecision(0)
+                  << static_cast<double>(bwt.block_size()) / 1024.0
+                  << std::setw(12) << std::fixed << std::setprecision(1)
+                  << static_cast<double>(usage.compress) / (1024.0 * 1024.0)
+                  << std::setw(12) << std::fixed << std::setprecision(1)
+                  << static_cast<double>(usage.decompress) / (1024.0 * 1024.0)
+                  << std::setw(10) << compress_threads
+                  << std::setw(14) << std::fixed << std::setprecision(1)
+                  << static_cast<double>(usage.compress * compress_threads) / (1024.0 * 1024.0)
+                  << std::setw(10) << decompress_threads
+                  << std::setw(14) << std::fixed << std::setprecision(1)
+                  << static_cast<double>(usage.decompress * decompress_threads) / (1024.0 * 1024.0)
+                  << '\n';
+    }
+}
+
 } // namespace
 
 int main(int argc, char** argv) {
@@ -205,5 +249,7 @@ int main(int argc, char** argv) {
         }
     }
 
+    print_bwt_memory();
+
     return 0;
 }
@@ -233,23 +233,24 @@ std::future<void> write_async(const std::filesystem::path& path,
 
 std::future<std::vector<Byte>> compress_file_async(
     const std::filesystem::path& path,
-    const std::string& algorithm) {
+    const std::string& algorithm,
+    CompressionLevel level) {
     
-    return std::async(std::launch::async, [path, algorithm]() {
+    return std::async(std::launch::async, [path, algorithm, level]() {
         MappedFile file(path);
-        auto compressor = create_compressor(algorithm);
+        auto compressor = create_compressor(algorithm, level);
         auto compressed = compressor->compress(file.as_string_view());
         
         auto id = algorithm_id_from_name(algorithm);
-        return pack_container(id, file.size(), compressed);
+        return pack_container(id, file.size(), compressed, compressor->format_version());
     });
 }
 
 std::future<std::string> decompress_file_async(const std::filesystem::path& path) {
     return std::async(std::launch::async, [path]() {
         auto data = read_binary_file(path.string());
-        auto [id, orig_size, payload] = unpack_container(data);
-        auto compressor = create_compressor(id);
+        auto [id, orig_size, payload, format_version] = unpack_container(data);
+        auto compressor = create_decompressor(id, format_version);
         return compressor->decompress(payload);
     });
 }
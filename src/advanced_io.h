@@ -119,7 +119,8 @@ std::future<void> write_async(const std::filesystem::path& path,
 // 异步压缩文件
 std::future<std::vector<Byte>> compress_file_async(
     const std::filesystem::path& path,
-    const std::string& algorithm);
+    const std::string& algorithm,
+    CompressionLevel level = CompressionLevel::Default);
 
 // 异步解压文件
 std::future<std::string> decompress_file_async(const std::filesystem::path& path);
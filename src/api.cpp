@@ -13,16 +13,18 @@ namespace compressup {
 
 void compress_file(const std::string& input_path,
                    const std::string& output_path,
-                   const std::string& algorithm_name) {
+                   const std::string& algorithm_name,
+                   CompressionLevel level) {
     std::string text = read_text_file(input_path);
 
     AlgorithmId id = algorithm_id_from_name(algorithm_name);
-    auto compressor = create_compressor(id);
+    auto compressor = create_compressor(id, level);
 
     std::vector<Byte> compressed = compressor->compress(text);
 
     std::uint64_t original_size = static_cast<std::uint64_t>(text.size());
-    std::vector<Byte> container = pack_container(id, original_size, compressed);
+    std::vector<Byte> container = pack_container(id, original_size, compressed,
+                                                 compressor->format_version());
 
     write_binary_file(output_path, container);
 }
@@ -33,7 +35,7 @@ void decompress_file(const std::string& input_path,
 
     UnpackedContainer unpacked = unpack_container(data);
 
-    auto compressor = create_compressor(unpacked.algorithm);
+    auto compressor = create_decompressor(unpacked.algorithm, unpacked.format_version);
     std::string text = compressor->decompress(unpacked.payload);
 
     if (static_cast<std::uint64_t>(text.size()) != unpacked.original_size) {
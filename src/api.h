@@ -1,12 +1,15 @@
 #pragma once
 
+#include "types.h"
+
 #include <string>
 
 namespace compressup {
 
 void compress_file(const std::string& input_path,
                    const std::string& output_path,
-                   const std::string& algorithm_name);
+                   const std::string& algorithm_name,
+                   CompressionLevel level = CompressionLevel::Default);
 
 void decompress_file(const std::string& input_path,
                      const std::string& output_path);
@@ -0,0 +1,139 @@
+#pragma once
+
+#include "types.h"
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace compressup {
+
+// 高位优先的比特读取器：64 位缓冲区，按字节补充，缓冲区左对齐（下一个比特在最高位）。
+// 读到输入末尾之后补 0，调用方通过 bits_consumed() 判断是否越过了有效数据。
+class BitReader {
+public:
+    BitReader(const Byte* begin, const Byte* end)
+        : begin_(begin)
+        , ptr_(begin)
+        , end_(end) {
+        refill();
+    }
+
+    // 补充缓冲区，保证至少有 kMinBits 个可用比特（不超过 63 个）
+    void refill() {
+        if (end_ - ptr_ >= 8) {
+            std::uint64_t word;
+            std::memcpy(&word, ptr_, 8);
+            if constexpr (std::endian::native == std::endian::little) {
+                word = __builtin_bswap64(word);
+            }
+            // 多读入的低位比特与之后再次读入的值相同，重复 OR 不影响结果
+            buffer_ |= word >> count_;
+            const unsigned bytes = (63 - count_) >> 3;
+            ptr_ += bytes;
+            count_ += bytes * 8;
+            return;
+        }
+
+        while (count_ <= 55) {
+            std::uint64_t byte = 0;
+            if (ptr_ < end_) {
+                byte = *ptr_++;
+            } else {
+                ++padding_;
+            }
+            buffer_ |= byte << (56 - count_);
+            count_ += 8;
+        }
+    }
+
+    // 查看接下来的 n 个比特（1 <= n <= available()）
+    std::uint32_t peek(unsigned n) const {
+        return static_cast<std::uint32_t>(buffer_ >> (64 - n));
+    }
+
+    void consume(unsigned n) {
+        buffer_ <<= n;
+        count_ -= n;
+    }
+
+    // 读取并消耗 n 个比特（0 <= n <= 32 且 n <= available()）。n 为 0 时返回 0，
+    // 供每符号比特数可能为 0 的表驱动解码（如 tANS）无分支地使用
+    std::uint32_t read(unsigned n) {
+        const auto value = static_cast<std::uint32_t>((buffer_ >> 1) >> (63 - n));
+        consume(n);
+        return value;
+    }
+
+    unsigned available() const { return count_; }
+
+    // 已消耗的比特数（包括越过输入末尾的补 0 比特）
+    std::uint64_t bits_consumed() const {
+        return (static_cast<std::uint64_t>(ptr_ - begin_) + padding_) * 8 - count_;
+    }
+
+    static constexpr unsigned kMinBits = 56;
+
+private:
+    const Byte* begin_;
+    const Byte* ptr_;
+    const Byte* end_;
+    std::uint64_t buffer_ = 0;
+    unsigned count_ = 0;
+    std::uint64_t padding_ = 0;
+};
+
+// 高位优先的比特写入器：码字先累积在 64 位寄存器中，满 64 位时整字写出，
+// 与 BitReader 的比特顺序一致。
+class BitWriter {
+public:
+    explicit BitWriter(std::vector<Byte>& output)
+        : output_(output) {
+    }
+
+    // 写入 code 的低 length 位（1 <= length <= 64，code 的更高位必须为 0），高位先写
+    void write(std::uint64_t code, unsigned length) {
+        const unsigned space = 64 - count_;
+        if (length < space) {
+            buffer_ |= code << (space - length);
+            count_ += length;
+            return;
+        }
+
+        // 寄存器被填满：先写满 64 位，剩余的低位留在寄存器中
+        const unsigned rest = length - space;
+        buffer_ |= code >> rest;
+        flush_word();
+        buffer_ = rest == 0 ? 0 : code << (64 - rest);
+        count_ = rest;
+    }
+
+    // 写出寄存器中剩余的比特，最后一个字节低位补 0
+    void finish() {
+        while (count_ > 0) {
+            output_.push_back(static_cast<Byte>(buffer_ >> 56));
+            buffer_ <<= 8;
+            count_ = count_ > 8 ? count_ - 8 : 0;
+        }
+        buffer_ = 0;
+    }
+
+private:
+    void flush_word() {
+        std::uint64_t word = buffer_;
+        if constexpr (std::endian::native == std::endian::little) {
+            word = __builtin_bswap64(word);
+        }
+        const std::size_t size = output_.size();
+        output_.resize(size + 8);
+        std::memcpy(output_.data() + size, &word, 8);
+    }
+
+    std::vector<Byte>& output_;
+    std::uint64_t buffer_ = 0;
+    unsigned count_ = 0;
+};
+
+} // namespace compressup
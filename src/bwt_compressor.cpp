@@ -1,145 +1,432 @@
 #include "bwt_compressor.h"
 
+#include "bwt_entropy.h"
+#include "parallel_compressor.h"
+#include "range_coder.h"
+#include "suffix_array.h"
+#include "varint.h"
+
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstring>
+#include <exception>
+#include <future>
 #include <numeric>
 #include <stdexcept>
+#include <thread>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <emmintrin.h>
+#define COMPRESSUP_X86 1
+#endif
 
 namespace compressup {
 
-std::string BwtCompressor::name() const {
-    return "bwt";
+namespace {
+
+// MTF 字母表：固定 256 字节数组，查找按 16 字节块比较，移到前端用 memmove
+struct MtfAlphabet {
+    alignas(16) std::array<Byte, 256> symbols;
+
+    MtfAlphabet() {
+        std::iota(symbols.begin(), symbols.end(), 0);
+    }
+
+    // 字节 c 的当前位置（字母表是排列，c 一定存在）
+    std::size_t find(Byte c) const {
+#ifdef COMPRESSUP_X86
+        const __m128i needle = _mm_set1_epi8(static_cast<char>(c));
+        for (std::size_t base = 0;; base += 16) {
+            const __m128i block = _mm_load_si128(reinterpret_cast<const __m128i*>(symbols.data() + base));
+            const auto mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(block, needle)));
+            if (mask != 0) {
+                return base + static_cast<std::size_t>(std::countr_zero(mask));
+            }
+        }
+#else
+        return static_cast<std::size_t>(std::find(symbols.begin(), symbols.end(), c) - symbols.begin());
+#endif
+    }
+
+    void move_to_front(std::size_t rank) {
+        const Byte c = symbols[rank];
+        std::memmove(symbols.data() + 1, symbols.data(), rank);
+        symbols[0] = c;
+    }
+};
+
+// 长度字段：版本 1~3 为 8 字节小端序，版本 4 为 varint
+void write_length(std::vector<Byte>& output, std::uint64_t value, bool varint) {
+    if (varint) {
+        write_varint(output, value);
+        return;
+    }
+    for (int i = 0; i < 8; ++i) {
+        output.push_back(static_cast<Byte>(value >> (i * 8)));
+    }
 }
 
-std::pair<std::string, std::size_t> BwtCompressor::bwt_transform(std::string_view input) const {
-    if (input.empty()) {
-        return {"", 0};
+std::uint64_t read_length(const Byte*& data, const Byte* end, bool varint) {
+    if (varint) {
+        return read_varint(data, end);
     }
-    
-    std::size_t n = input.size();
-    
-    // 创建后缀数组
-    std::vector<std::size_t> indices(n);
-    std::iota(indices.begin(), indices.end(), 0);
-    
-    // 按循环移位后的字符串排序
-    std::sort(indices.begin(), indices.end(), [&input, n](std::size_t a, std::size_t b) {
-        for (std::size_t i = 0; i < n; ++i) {
-            unsigned char ca = static_cast<unsigned char>(input[(a + i) % n]);
-            unsigned char cb = static_cast<unsigned char>(input[(b + i) % n]);
-            if (ca != cb) {
-                return ca < cb;
+    if (end - data < 8) {
+        throw std::runtime_error("BWT: truncated header");
+    }
+    std::uint64_t value = 0;
+    for (int i = 0; i < 8; ++i) {
+        value |= static_cast<std::uint64_t>(*data++) << (i * 8);
+    }
+    return value;
+}
+
+// 版本 4 起长度与块头为 varint
+bool uses_varint_header(BwtFormat format) {
+    return format >= BwtFormat::LargeBlock;
+}
+
+// 不小于该大小的块（版本 5）记录 kDecodeCursors 个段起点，更小的块只记录 primary_index
+constexpr std::size_t kMultiCursorMinBlock = 64 * 1024;
+
+// 把长度为 n 的块均分为 cursors 段时第 j 段的起点
+std::size_t segment_start(std::size_t j, std::size_t n, std::size_t cursors) {
+    return j * n / cursors;
+}
+
+// 逆变换的 K 个游标：各段长度相差不超过 1，先同步走完最短段长，K 条互不依赖的访存链
+// 交错执行，使缓存未命中的等待相互重叠；再各自走完剩余的一步
+template <std::size_t K>
+void inverse_walk(const std::uint32_t* tt, const std::size_t* rows, std::size_t n, char* output) {
+    std::array<std::uint32_t, K> entry;
+    std::array<char*, K> out;
+    for (std::size_t j = 0; j < K; ++j) {
+        entry[j] = tt[rows[j]];
+        out[j] = output + segment_start(j, n, K);
+    }
+
+    const std::size_t common = n / K;
+    for (std::size_t step = 0; step < common; ++step) {
+        for (std::size_t j = 0; j < K; ++j) {
+            entry[j] = tt[entry[j] >> 8];
+            out[j][step] = static_cast<char>(entry[j]);
+        }
+    }
+    for (std::size_t j = 0; j < K; ++j) {
+        const std::size_t length = segment_start(j + 1, n, K) - segment_start(j, n, K);
+        for (std::size_t step = common; step < length; ++step) {
+            entry[j] = tt[entry[j] >> 8];
+            out[j][step] = static_cast<char>(entry[j]);
+        }
+    }
+}
+
+// 解析块头得到的块位置
+struct BlockRef {
+    std::array<std::size_t, BwtCompressor::kDecodeCursors> rows{};
+    std::size_t cursors{1};
+    std::uint64_t size{0};
+    std::size_t offset{0};       // 在输出中的起始位置
+    const Byte* data{nullptr};   // 编码数据 [data, end)
+    const Byte* end{nullptr};
+};
+
+// 处理 count 个互相独立的块：最多 num_threads 个线程，每个线程持有一份 Scratch，
+// 按原子计数器依次领取块序号；只有一个块或一个线程时直接在当前线程执行
+template <typename Scratch, typename Fn>
+void for_each_block(std::size_t count, std::size_t num_threads, Fn fn) {
+    const std::size_t threads = std::min(count, num_threads);
+    if (threads <= 1) {
+        Scratch scratch;
+        for (std::size_t i = 0; i < count; ++i) {
+            fn(i, scratch);
+        }
+        return;
+    }
+
+    std::atomic<std::size_t> next{0};
+    std::atomic<bool> failed{false};
+    ThreadPool pool(threads);
+    std::vector<std::future<void>> futures;
+    for (std::size_t t = 0; t < threads; ++t) {
+        futures.push_back(pool.submit([&]() {
+            Scratch scratch;
+            try {
+                for (std::size_t i = next++; i < count && !failed; i = next++) {
+                    fn(i, scratch);
+                }
+            } catch (...) {
+                failed = true;
+                throw;
+            }
+        }));
+    }
+    // 等待所有线程结束后再抛出第一个异常
+    std::exception_ptr error;
+    for (auto& f : futures) {
+        try {
+            f.get();
+        } catch (...) {
+            if (!error) {
+                error = std::current_exception();
             }
         }
-        return false;
-    });
-    
-    // 构建BWT输出：每个排序位置的前一个字符
-    std::string output;
-    output.reserve(n);
-    std::size_t primary_index = 0;
-    
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+} // namespace
+
+BwtCompressor::BwtCompressor(CompressionLevel level, BwtFormat format)
+    : format_(format) {
+    // 块越大可利用的上下文越多，但排序耗时与内存随之增加
+    if (!uses_varint_header(format_)) {
+        switch (level) {
+        case CompressionLevel::Fastest:
+            block_size_ = 32 * 1024;
+            break;
+        case CompressionLevel::Fast:
+            block_size_ = 64 * 1024;
+            break;
+        default:
+            block_size_ = kLegacyMaxBlockSize;
+            break;
+        }
+        return;
+    }
+
+    switch (level) {
+    case CompressionLevel::Fastest:
+        block_size_ = kMinBlockSize;
+        break;
+    case CompressionLevel::Fast:
+        block_size_ = 256 * 1024;
+        break;
+    case CompressionLevel::Default:
+        block_size_ = 1024 * 1024;
+        break;
+    case CompressionLevel::Better:
+        block_size_ = 4 * 1024 * 1024;
+        break;
+    case CompressionLevel::Best:
+        block_size_ = kMaxBlockSize;
+        break;
+    }
+}
+
+BwtCompressor::BwtCompressor(std::size_t block_size, BwtFormat format)
+    : block_size_(block_size)
+    , format_(format) {
+    const std::size_t limit = uses_varint_header(format_) ? kMaxBlockSize : kLegacyMaxBlockSize;
+    if (block_size < kMinBlockSize || block_size > limit) {
+        throw std::invalid_argument("BWT: block size out of range");
+    }
+}
+
+BwtMemoryUsage BwtCompressor::memory_usage(std::size_t block_size) {
+    // 压缩：SA-IS 顶层的后缀数组、L/S 类型与 LMS 相关数组约 13n，加上递归与 Lyndon 副本，
+    // 实测文本约 16n、随机数据约 21n（含 BWT 输出、MTF 输出、0 游程符号与编码结果）
+    // 解压：MTF 数据与 32 位的 T 向量（BWT 字符与下一行打包在一起）共 5n
+    return {22 * block_size, 5 * block_size};
+}
+
+std::string BwtCompressor::name() const {
+    return "bwt";
+}
+
+std::unique_ptr<ICompressor> BwtCompressor::clone() const {
+    return std::make_unique<BwtCompressor>(*this);
+}
+
+std::uint8_t BwtCompressor::format_version() const {
+    return static_cast<std::uint8_t>(format_);
+}
+
+std::size_t BwtCompressor::thread_count(std::size_t worker_memory) const {
+    if (num_threads_ != 0) {
+        return num_threads_;
+    }
+    const std::size_t cores = std::max(1u, std::thread::hardware_concurrency());
+    const std::size_t affordable = worker_memory == 0 ? cores : memory_budget_ / worker_memory;
+    return std::clamp<std::size_t>(affordable, 1, cores);
+}
+
+void BwtCompressor::bwt_transform(std::string_view input, std::size_t cursors, CursorRows& rows,
+                                  BlockScratch& scratch) const {
+    const std::size_t n = input.size();
+    scratch.bwt.resize(n);
+    rows.fill(0);
+    if (n == 0) {
+        return;
+    }
+
+    // 循环旋转按字典序排列（SA-IS，O(n)），相等的旋转按起始位置升序
+    sort_rotations(reinterpret_cast<const Byte*>(input.data()), n, scratch.rotations);
+
+    // 构建BWT输出：每个排序位置的前一个字符；同时记下各段起点所在的行
     for (std::size_t i = 0; i < n; ++i) {
-        if (indices[i] == 0) {
-            primary_index = i;
-            output.push_back(input[n - 1]);
-        } else {
-            output.push_back(input[indices[i] - 1]);
+        const auto start = static_cast<std::size_t>(scratch.rotations[i]);
+        if (start == 0) {
+            rows[0] = i;
+            scratch.bwt[i] = input[n - 1];
+            continue;
+        }
+        scratch.bwt[i] = input[start - 1];
+        if (cursors > 1) {
+            // start 为第 j 段起点时 j = ceil(start * cursors / n)
+            const std::size_t j = (start * cursors + n - 1) / n;
+            if (j < cursors && segment_start(j, n, cursors) == start) {
+                rows[j] = i;
+            }
         }
     }
-    
-    return {output, primary_index};
 }
 
-std::string BwtCompressor::bwt_inverse(std::string_view input, std::size_t primary_index) const {
-    if (input.empty()) {
-        return "";
+void BwtCompressor::bwt_inverse(std::vector<std::uint32_t>& tt, const CursorRows& rows,
+                                std::size_t cursors, char* output) const {
+    const std::size_t n = tt.size();
+    if (n == 0) {
+        return;
     }
-    
-    std::size_t n = input.size();
-    
-    if (primary_index >= n) {
-        throw std::runtime_error("BWT: invalid primary index");
+    for (std::size_t j = 0; j < cursors; ++j) {
+        if (rows[j] >= n) {
+            throw std::runtime_error("BWT: invalid primary index");
+        }
     }
     
-    // 计数排序：统计每个字符出现次数
-    std::array<std::size_t, 256> count{};
-    for (unsigned char c : input) {
-        ++count[c];
+    // 计数排序：统计每个字符出现次数，得到每个字符在第一列的起始位置
+    std::array<std::uint32_t, 256> count{};
+    for (std::uint32_t entry : tt) {
+        ++count[entry & 0xFF];
     }
-    
-    // 计算每个字符在第一列的起始位置
-    std::array<std::size_t, 256> cumsum{};
-    std::size_t sum = 0;
+    std::array<std::uint32_t, 256> cumsum{};
+    std::uint32_t sum = 0;
     for (int c = 0; c < 256; ++c) {
         cumsum[c] = sum;
         sum += count[c];
     }
     
-    // 构建LF映射：对于最后一列位置i的字符c，它在第一列的位置
-    // LF[i] = cumsum[c] + (c在位置i之前在最后一列出现的次数)
-    std::vector<std::size_t> lf(n);
-    std::array<std::size_t, 256> seen{};
+    // T 向量（同 bzip2）：最后一列第 i 行的字符 c 在第一列的位置为 j = LF(i)，在 tt[j] 的高 24 位
+    // 记下 i，即从起点为 s 的行走到起点为 s + 1 的行；tt[i] 的低 8 位为 BWT 字符 L[i]。
+    // 字符与下一行放在同一个 32 位字中，每步只访问一次内存；块不超过 16 MB，行号不超过 24 位
     for (std::size_t i = 0; i < n; ++i) {
-        unsigned char c = static_cast<unsigned char>(input[i]);
-        lf[i] = cumsum[c] + seen[c];
-        ++seen[c];
+        tt[cumsum[tt[i] & 0xFF]++] |= static_cast<std::uint32_t>(i) << 8;
     }
     
-    // 逆变换：从primary_index开始，向后遍历
-    std::string output(n, '\0');
-    std::size_t idx = primary_index;
-    for (std::size_t i = n; i > 0; --i) {
-        output[i - 1] = input[idx];
-        idx = lf[idx];
+    // 正向还原：从起点为 s 的行出发，每步走到下一行并输出其 BWT 字符，即 input[s], input[s + 1], ...
+    switch (cursors) {
+    case 1:
+        inverse_walk<1>(tt.data(), rows.data(), n, output);
+        break;
+    case 2:
+        inverse_walk<2>(tt.data(), rows.data(), n, output);
+        break;
+    case 3:
+        inverse_walk<3>(tt.data(), rows.data(), n, output);
+        break;
+    default:
+        inverse_walk<4>(tt.data(), rows.data(), n, output);
+        break;
     }
-    
-    return output;
 }
 
-std::vector<Byte> BwtCompressor::mtf_encode(std::string_view input) const {
-    // 初始化字母表
-    std::vector<Byte> alphabet(256);
-    std::iota(alphabet.begin(), alphabet.end(), 0);
-    
-    std::vector<Byte> output;
-    output.reserve(input.size());
-    
-    for (unsigned char c : input) {
-        // 查找字符位置
-        auto it = std::find(alphabet.begin(), alphabet.end(), c);
-        std::size_t pos = static_cast<std::size_t>(it - alphabet.begin());
-        output.push_back(static_cast<Byte>(pos));
-        
-        // 将字符移到前面
-        if (pos > 0) {
-            alphabet.erase(it);
-            alphabet.insert(alphabet.begin(), c);
+void BwtCompressor::mtf_encode(std::string_view input, std::vector<Byte>& output) const {
+    MtfAlphabet alphabet;
+    output.resize(input.size());
+
+    for (std::size_t i = 0; i < input.size(); ++i) {
+        const auto c = static_cast<Byte>(input[i]);
+        // BWT 输出中大多数字符与前一两个字符相同，秩 0、1 不需要查找与移动
+        if (alphabet.symbols[0] == c) {
+            output[i] = 0;
+        } else if (alphabet.symbols[1] == c) {
+            alphabet.symbols[1] = alphabet.symbols[0];
+            alphabet.symbols[0] = c;
+            output[i] = 1;
+        } else {
+            const std::size_t rank = alphabet.find(c);
+            alphabet.move_to_front(rank);
+            output[i] = static_cast<Byte>(rank);
         }
     }
-    
-    return output;
 }
 
-std::string BwtCompressor::mtf_decode(const std::vector<Byte>& input) const {
-    // 初始化字母表
-    std::vector<Byte> alphabet(256);
-    std::iota(alphabet.begin(), alphabet.end(), 0);
-    
-    std::string output;
-    output.reserve(input.size());
-    
-    for (Byte pos : input) {
-        Byte c = alphabet[pos];
-        output.push_back(static_cast<char>(c));
-        
-        // 将字符移到前面
-        if (pos > 0) {
-            alphabet.erase(alphabet.begin() + pos);
-            alphabet.insert(alphabet.begin(), c);
+void BwtCompressor::mtf_decode(const std::vector<Byte>& input, std::vector<std::uint32_t>& tt) const {
+    MtfAlphabet alphabet;
+    tt.resize(input.size());
+
+    for (std::size_t i = 0; i < input.size(); ++i) {
+        const Byte rank = input[i];
+        if (rank == 1) {
+            std::swap(alphabet.symbols[0], alphabet.symbols[1]);
+        } else if (rank > 1) {
+            alphabet.move_to_front(rank);
         }
+        tt[i] = alphabet.symbols[0];
     }
-    
-    return output;
+}
+
+void BwtCompressor::encode_block(std::string_view chunk, BlockScratch& scratch,
+                                 std::vector<Byte>& output) const {
+    const bool varint_header = uses_varint_header(format_);
+
+    // BWT变换
+    std::size_t cursors = 1;
+    if (format_ == BwtFormat::MultiCursor && chunk.size() >= kMultiCursorMinBlock) {
+        cursors = kDecodeCursors;
+    }
+    CursorRows rows;
+    bwt_transform(chunk, cursors, rows, scratch);
+
+    // 写入段起点行（版本 5 为 [varint 段数][各段起点行]，之前的版本只有 primary_index）与块大小
+    if (format_ == BwtFormat::MultiCursor) {
+        write_varint(output, cursors);
+        for (std::size_t j = 0; j < cursors; ++j) {
+            write_varint(output, rows[j]);
+        }
+    } else {
+        write_length(output, rows[0], varint_header);
+    }
+    write_length(output, chunk.size(), varint_header);
+
+    // MTF编码
+    mtf_encode(scratch.bwt, scratch.mtf);
+
+    if (format_ != BwtFormat::Mtf) {
+        // MTF 输出以小数值为主，经熵编码后写入 [varint 编码长度][编码数据]
+        scratch.coded.clear();
+        if (format_ == BwtFormat::MtfRange) {
+            range_encode_bytes(scratch.coded, scratch.mtf.data(), scratch.mtf.size());
+        } else {
+            zero_run_huffman_encode(scratch.coded, scratch.mtf.data(), scratch.mtf.size());
+        }
+        write_varint(output, scratch.coded.size());
+        output.insert(output.end(), scratch.coded.begin(), scratch.coded.end());
+    } else {
+        // 写入MTF数据
+        output.insert(output.end(), scratch.mtf.begin(), scratch.mtf.end());
+    }
+}
+
+void BwtCompressor::decode_block(const Byte* data, const Byte* end, std::size_t chunk_size,
+                                 const CursorRows& rows, std::size_t cursors,
+                                 BlockScratch& scratch, char* output) const {
+    if (format_ == BwtFormat::Mtf) {
+        scratch.mtf.assign(data, end);
+    } else if (format_ == BwtFormat::MtfRange) {
+        scratch.mtf = range_decode_bytes(data, end, chunk_size);
+    } else {
+        zero_run_huffman_decode(data, end, chunk_size, scratch.mtf);
+    }
+
+    // MTF解码（直接写入 T 向量）
+    mtf_decode(scratch.mtf, scratch.tt);
+
+    // BWT逆变换
+    bwt_inverse(scratch.tt, rows, cursors, output);
 }
 
 std::vector<Byte> BwtCompressor::compress(std::string_view input) {
@@ -148,41 +435,23 @@ std::vector<Byte> BwtCompressor::compress(std::string_view input) {
     }
     
     // 限制块大小
-    std::size_t block_size = std::min(input.size(), kMaxBlockSize);
+    const std::size_t block_size = std::min(input.size(), block_size_);
+    const std::size_t block_count = (input.size() + block_size - 1) / block_size;
+    
+    // 各块独立编码到自己的缓冲区，再按顺序拼接
+    std::vector<std::vector<Byte>> encoded(block_count);
+    for_each_block<BlockScratch>(block_count, thread_count(), [&](std::size_t i, BlockScratch& scratch) {
+        const std::size_t pos = i * block_size;
+        encode_block(input.substr(pos, std::min(block_size, input.size() - pos)), scratch, encoded[i]);
+    });
     
     std::vector<Byte> output;
     
-    // 写入原始长度 (8字节, 小端序)
-    std::uint64_t orig_len = input.size();
-    for (int i = 0; i < 8; ++i) {
-        output.push_back(static_cast<Byte>(orig_len >> (i * 8)));
-    }
+    // 写入原始长度
+    write_length(output, input.size(), uses_varint_header(format_));
     
-    std::size_t pos = 0;
-    while (pos < input.size()) {
-        std::size_t chunk_size = std::min(block_size, input.size() - pos);
-        std::string_view chunk = input.substr(pos, chunk_size);
-        
-        // BWT变换
-        auto [bwt_output, primary_index] = bwt_transform(chunk);
-        
-        // 写入primary_index (8字节)
-        for (int i = 0; i < 8; ++i) {
-            output.push_back(static_cast<Byte>(primary_index >> (i * 8)));
-        }
-        
-        // 写入块大小 (8字节)
-        for (int i = 0; i < 8; ++i) {
-            output.push_back(static_cast<Byte>(chunk_size >> (i * 8)));
-        }
-        
-        // MTF编码
-        auto mtf_output = mtf_encode(bwt_output);
-        
-        // 写入MTF数据
-        output.insert(output.end(), mtf_output.begin(), mtf_output.end());
-        
-        pos += chunk_size;
+    for (const auto& block : encoded) {
+        output.insert(output.end(), block.begin(), block.end());
     }
     
     return output;
@@ -193,54 +462,69 @@ std::string BwtCompressor::decompress(const std::vector<Byte>& input) {
         return {};
     }
     
-    if (input.size() < 8) {
-        throw std::runtime_error("BWT: input too short");
-    }
-    
     const Byte* data = input.data();
     const Byte* end = data + input.size();
+    const bool varint_header = uses_varint_header(format_);
+    const std::size_t max_block_size = varint_header ? kMaxBlockSize : kLegacyMaxBlockSize;
     
     // 读取原始长度
-    std::uint64_t orig_len = 0;
-    for (int i = 0; i < 8; ++i) {
-        orig_len |= static_cast<std::uint64_t>(*data++) << (i * 8);
-    }
+    const std::uint64_t orig_len = read_length(data, end, varint_header);
     
-    std::string output;
-    output.reserve(orig_len);
-    
-    while (output.size() < orig_len && data + 16 <= end) {
-        // 读取primary_index
-        std::uint64_t primary_index = 0;
-        for (int i = 0; i < 8; ++i) {
-            primary_index |= static_cast<std::uint64_t>(*data++) << (i * 8);
+    // 先顺序解析所有块头确定各块的位置，块大小之和必须等于原始长度
+    std::vector<BlockRef> blocks;
+    std::uint64_t total = 0;
+    while (total < orig_len && data < end) {
+        BlockRef block;
+        if (format_ == BwtFormat::MultiCursor) {
+            const std::uint64_t cursors = read_varint(data, end);
+            if (cursors == 0 || cursors > kDecodeCursors) {
+                throw std::runtime_error("BWT: invalid cursor count");
+            }
+            block.cursors = static_cast<std::size_t>(cursors);
+            for (std::size_t j = 0; j < block.cursors; ++j) {
+                block.rows[j] = read_varint(data, end);
+            }
+        } else {
+            block.rows[0] = read_length(data, end, varint_header);
         }
-        
-        // 读取块大小
-        std::uint64_t chunk_size = 0;
-        for (int i = 0; i < 8; ++i) {
-            chunk_size |= static_cast<std::uint64_t>(*data++) << (i * 8);
+        block.size = read_length(data, end, varint_header);
+        // 逆变换的 T 向量中行号占 24 位，块大小不得超过上限（版本 1 的块同样不超过 100000）
+        if (block.size == 0 || block.size > orig_len - total || block.size > max_block_size) {
+            throw std::runtime_error("BWT: invalid chunk size");
         }
         
-        if (data + chunk_size > end) {
+        std::uint64_t coded_size = block.size;
+        if (format_ != BwtFormat::Mtf) {
+            coded_size = read_varint(data, end);
+        }
+        if (coded_size > static_cast<std::uint64_t>(end - data)) {
             throw std::runtime_error("BWT: invalid chunk size");
         }
-        
-        // MTF解码
-        std::vector<Byte> mtf_data(data, data + chunk_size);
-        data += chunk_size;
-        
-        std::string bwt_data = mtf_decode(mtf_data);
-        
-        // BWT逆变换
-        std::string decoded = bwt_inverse(bwt_data, primary_index);
-        output += decoded;
+        block.data = data;
+        block.end = data + coded_size;
+        block.offset = total;
+        data += coded_size;
+        total += block.size;
+        blocks.push_back(block);
     }
     
-    if (output.size() != orig_len) {
+    if (total != orig_len) {
         throw std::runtime_error("BWT: output size mismatch");
     }
     
+    // 各块解码到输出中各自的位置
+    std::string output(orig_len, '\0');
+    std::size_t largest_block = 0;
+    for (const BlockRef& block : blocks) {
+        largest_block = std::max<std::size_t>(largest_block, block.size);
+    }
+    const std::size_t threads = thread_count(memory_usage(largest_block).decompress);
+    for_each_block<BlockScratch>(blocks.size(), threads, [&](std::size_t i, BlockScratch& scratch) {
+        const BlockRef& block = blocks[i];
+        decode_block(block.data, block.end, block.size, block.rows, block.cursors, scratch,
+                     output.data() + block.offset);
+    });
+    
     return output;
 }
 
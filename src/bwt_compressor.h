@@ -2,31 +2,108 @@
 
 #include "compressor.h"
 
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
 namespace compressup {
 
+// BWT 流格式版本
+enum class BwtFormat : std::uint8_t {
+    Mtf = 1,       // MTF 输出直接存储
+    MtfRange = 2,  // MTF 输出经自适应区间编码
+    MtfHuffman = 3,  // MTF 输出经 0 游程编码与多表 Huffman 编码（bzip2 式）
+    LargeBlock = 4,  // 熵编码同版本 3，长度与块头改为 varint，块大小可达 kMaxBlockSize
+    MultiCursor = 5,  // 同版本 4，每块记录多个段起点所在的行，解压时多个游标交错逆变换
+};
+
+// 单个块的工作内存峰值（字节，不含整个输入与输出的缓冲区）
+struct BwtMemoryUsage {
+    std::size_t compress{0};
+    std::size_t decompress{0};
+};
+
 // BWT (Burrows-Wheeler Transform) 结合 MTF (Move-to-Front) 编码
 // BWT将输入重新排列使相同字符聚集，MTF利用局部性原理编码
 class BwtCompressor : public ICompressor {
 public:
+    // 压缩级别决定块大小：版本 4 起从 100 KB 到 16 MB，旧格式不超过 kLegacyMaxBlockSize
+    explicit BwtCompressor(CompressionLevel level = CompressionLevel::Default,
+                           BwtFormat format = BwtFormat::MultiCursor);
+    // 显式指定块大小，范围 [kMinBlockSize, kMaxBlockSize]（旧格式不超过 kLegacyMaxBlockSize）
+    explicit BwtCompressor(std::size_t block_size, BwtFormat format = BwtFormat::MultiCursor);
+
     std::string name() const override;
+    std::unique_ptr<ICompressor> clone() const override;
     std::vector<Byte> compress(std::string_view input) override;
     std::string decompress(const std::vector<Byte>& input) override;
+    std::uint8_t format_version() const override;
     
     // 块大小限制
-    static constexpr std::size_t kMaxBlockSize = 100000;
+    static constexpr std::size_t kMinBlockSize = 100000;
+    static constexpr std::size_t kMaxBlockSize = 16 * 1024 * 1024;
+    // 版本 1~3 的块头为定长字段，块大小不超过 100000
+    static constexpr std::size_t kLegacyMaxBlockSize = 100000;
+    // 版本 5 每块最多记录的段起点数（解压时交错推进的游标数）
+    static constexpr std::size_t kDecodeCursors = 4;
+
+    std::size_t block_size() const { return block_size_; }
+
+    // 块并行的线程数，0 表示自动；各块互相独立，输出与线程数无关
+    void set_thread_count(std::size_t num_threads) { num_threads_ = num_threads; }
+    // 自动线程数时的内存预算：线程数取 CPU 核数，但线程数 × 每线程工作内存不超过预算（至少 1 个线程）
+    static constexpr std::size_t kDefaultMemoryBudget = std::size_t{1} << 30;
+    void set_memory_budget(std::size_t bytes) { memory_budget_ = bytes; }
+    std::size_t memory_budget() const { return memory_budget_; }
+    // 每线程需要 worker_memory 字节时使用的线程数；不带参数为按本实例块大小压缩时的线程数
+    std::size_t thread_count(std::size_t worker_memory) const;
+    std::size_t thread_count() const { return thread_count(memory_usage().compress); }
+
+    // 按块大小估计压缩与解压每个块时的工作内存峰值，供使用者按可用内存选择块大小；
+    // 并行时每个线程各占一份
+    static BwtMemoryUsage memory_usage(std::size_t block_size);
+    BwtMemoryUsage memory_usage() const { return memory_usage(block_size_); }
 
 private:
-    // BWT变换
-    std::pair<std::string, std::size_t> bwt_transform(std::string_view input) const;
+    // 每个线程持有一份，在该线程处理的各块之间复用
+    struct BlockScratch {
+        std::vector<std::int32_t> rotations;  // 循环旋转排序结果
+        std::string bwt;                      // BWT 输出
+        std::vector<Byte> mtf;                // MTF 输出 / 熵解码结果
+        std::vector<Byte> coded;              // 熵编码结果
+        std::vector<std::uint32_t> tt;        // 逆变换的 T 向量：(下一行 << 8) | BWT 字符
+    };
+
+    // 各段起点所在的行：第 0 段的起点即 primary_index
+    using CursorRows = std::array<std::size_t, kDecodeCursors>;
+
+    std::size_t block_size_;
+    BwtFormat format_;
+    std::size_t num_threads_ = 0;
+    std::size_t memory_budget_ = kDefaultMemoryBudget;
+
+    // 压缩一个块，写出 [段起点行][块大小][编码数据]
+    void encode_block(std::string_view chunk, BlockScratch& scratch, std::vector<Byte>& output) const;
+
+    // 解码一个块（编码数据为 [data, end)）到 output[0, chunk_size)
+    void decode_block(const Byte* data, const Byte* end, std::size_t chunk_size,
+                      const CursorRows& rows, std::size_t cursors,
+                      BlockScratch& scratch, char* output) const;
+
+    // BWT变换：结果写入 scratch.bwt，rows[0, cursors) 为把块均分为 cursors 段后各段起点所在的行
+    void bwt_transform(std::string_view input, std::size_t cursors, CursorRows& rows,
+                       BlockScratch& scratch) const;
     
-    // BWT逆变换
-    std::string bwt_inverse(std::string_view input, std::size_t primary_index) const;
+    // BWT逆变换：tt 的低 8 位为 BWT 输出，从各段起点所在的行出发交错还原各段
+    void bwt_inverse(std::vector<std::uint32_t>& tt, const CursorRows& rows, std::size_t cursors,
+                     char* output) const;
     
     // MTF编码
-    std::vector<Byte> mtf_encode(std::string_view input) const;
+    void mtf_encode(std::string_view input, std::vector<Byte>& output) const;
     
-    // MTF解码
-    std::string mtf_decode(const std::vector<Byte>& input) const;
+    // MTF解码：结果写入 tt 的低 8 位
+    void mtf_decode(const std::vector<Byte>& input, std::vector<std::uint32_t>& tt) const;
 };
 
 } // namespace compressup
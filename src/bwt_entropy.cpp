@@ -0,0 +1,343 @@
+#include "bwt_entropy.h"
+
+#include "bit_stream.h"
+#include "huffman_table.h"
+#include "varint.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+
+namespace compressup {
+
+namespace {
+
+// 符号表：RUNA、RUNB、MTF 值 v (1..253) 记为 v + 1；MTF 值 254 与 255 都很少见，
+// 共用符号 255 并在其后跟 1 位区分，使符号表不超过 256 个，可直接复用字节 Huffman 表
+constexpr std::uint16_t kRunA = 0;
+constexpr std::uint16_t kRunB = 1;
+constexpr std::uint16_t kEscape = 255;
+
+constexpr unsigned kMaxCodeLength = 17;
+constexpr unsigned kLengthBits = 5;
+constexpr unsigned kIterations = 4;
+// 表中缺少某符号时的代价，高于任意一组可能的最大代价 (50 × 17)，保证不会被选中；
+// 一组的代价不超过 50 × 1024，可以用 16 位累加
+constexpr std::uint16_t kMissingCost = 1024;
+
+using Lengths = std::array<std::uint8_t, 256>;
+using Frequencies = std::array<std::size_t, 256>;
+
+// 0 游程长度 r 写成以 RUNA = 1、RUNB = 2 为数字的双射二进制数（低位在前）
+void append_zero_run(std::vector<std::uint16_t>& symbols, std::size_t run) {
+    while (run > 0) {
+        --run;
+        symbols.push_back((run & 1) ? kRunB : kRunA);
+        run >>= 1;
+    }
+}
+
+// 返回的符号值为 0..256，256 表示 MTF 值 255
+std::vector<std::uint16_t> zero_run_encode(const Byte* mtf, std::size_t size) {
+    std::vector<std::uint16_t> symbols;
+    symbols.reserve(size / 2 + 16);
+    std::size_t run = 0;
+    for (std::size_t i = 0; i < size; ++i) {
+        if (mtf[i] == 0) {
+            ++run;
+            continue;
+        }
+        append_zero_run(symbols, run);
+        run = 0;
+        symbols.push_back(static_cast<std::uint16_t>(mtf[i] + 1));
+    }
+    append_zero_run(symbols, run);
+    return symbols;
+}
+
+Byte code_symbol(std::uint16_t symbol) {
+    return static_cast<Byte>(std::min(symbol, kEscape));
+}
+
+// 与 bzip2 相同：符号越多，表越多
+std::size_t table_count_for(std::size_t symbols) {
+    if (symbols < 200) return 2;
+    if (symbols < 600) return 3;
+    if (symbols < 1200) return 4;
+    if (symbols < 2400) return 5;
+    return kBwtMaxTables;
+}
+
+struct TableSet {
+    std::vector<Lengths> lengths;
+    std::vector<Byte> selectors;  // 每组使用的表
+};
+
+// 初始时按累计频率把符号表切成 table_count 段，每张表偏向其中一段；
+// 之后每轮为各组选择代价最小的表，再由各表分到的组重建码长
+TableSet optimize_tables(const std::vector<std::uint16_t>& symbols, unsigned alphabet_size) {
+    const std::size_t group_count = (symbols.size() + kBwtGroupSize - 1) / kBwtGroupSize;
+    std::size_t table_count = table_count_for(symbols.size());
+
+    Frequencies total{};
+    for (auto s : symbols) {
+        ++total[code_symbol(s)];
+    }
+
+    TableSet set;
+    set.lengths.assign(table_count, Lengths{});
+    std::size_t remaining = symbols.size();
+    unsigned low = 0;
+    for (std::size_t t = table_count; t > 0; --t) {
+        const std::size_t target = remaining / t;
+        unsigned high = low;
+        std::size_t taken = 0;
+        while (high < alphabet_size && (taken < target || high == low)) {
+            taken += total[high++];
+        }
+        auto& lengths = set.lengths[table_count - t];
+        for (unsigned s = 0; s < alphabet_size; ++s) {
+            lengths[s] = (s >= low && s < high) ? 1 : 15;
+        }
+        remaining -= std::min(taken, remaining);
+        low = high;
+    }
+
+    set.selectors.assign(group_count, 0);
+    // 按符号存放各表的代价，使一组的代价累加可以同时处理所有表
+    std::array<std::array<std::uint16_t, kBwtMaxTables>, 256> costs{};
+    for (unsigned iteration = 0; iteration < kIterations; ++iteration) {
+        for (std::size_t t = 0; t < table_count; ++t) {
+            for (unsigned s = 0; s < 256; ++s) {
+                costs[s][t] = set.lengths[t][s] == 0 ? kMissingCost : set.lengths[t][s];
+            }
+        }
+
+        std::vector<Frequencies> freqs(table_count, Frequencies{});
+        for (std::size_t g = 0; g < group_count; ++g) {
+            const std::size_t begin = g * kBwtGroupSize;
+            const std::size_t end = std::min(begin + kBwtGroupSize, symbols.size());
+
+            std::array<std::uint16_t, kBwtMaxTables> group_cost{};
+            for (std::size_t i = begin; i < end; ++i) {
+                const auto& cost = costs[code_symbol(symbols[i])];
+                for (std::size_t t = 0; t < kBwtMaxTables; ++t) {
+                    group_cost[t] = static_cast<std::uint16_t>(group_cost[t] + cost[t]);
+                }
+            }
+            const auto best = static_cast<Byte>(
+                std::min_element(group_cost.begin(), group_cost.begin() + table_count) - group_cost.begin());
+            set.selectors[g] = best;
+            for (std::size_t i = begin; i < end; ++i) {
+                ++freqs[best][code_symbol(symbols[i])];
+            }
+        }
+
+        for (std::size_t t = 0; t < table_count; ++t) {
+            set.lengths[t] = build_code_lengths(freqs[t], kMaxCodeLength);
+        }
+    }
+
+    // 去掉没有被任何组选中的表
+    std::array<int, kBwtMaxTables> remap;
+    remap.fill(-1);
+    std::vector<Lengths> used;
+    for (auto& selector : set.selectors) {
+        if (remap[selector] < 0) {
+            remap[selector] = static_cast<int>(used.size());
+            used.push_back(set.lengths[selector]);
+        }
+        selector = static_cast<Byte>(remap[selector]);
+    }
+    set.lengths = std::move(used);
+    return set;
+}
+
+// 码长逐个以与前一码长的差值写出：每步 "10" 加 1、"11" 减 1，"0" 结束
+void write_lengths(BitWriter& writer, const Lengths& lengths, unsigned alphabet_size) {
+    unsigned current = lengths[0];
+    writer.write(current, kLengthBits);
+    for (unsigned s = 0; s < alphabet_size; ++s) {
+        for (; current < lengths[s]; ++current) {
+            writer.write(2, 2);
+        }
+        for (; current > lengths[s]; --current) {
+            writer.write(3, 2);
+        }
+        writer.write(0, 1);
+    }
+}
+
+Lengths read_lengths(BitReader& reader, unsigned alphabet_size) {
+    Lengths lengths{};
+    reader.refill();
+    unsigned current = reader.read(kLengthBits);
+    for (unsigned s = 0; s < alphabet_size; ++s) {
+        for (;;) {
+            reader.refill();
+            if (reader.read(1) == 0) {
+                break;
+            }
+            if (reader.read(1) == 0) {
+                ++current;
+            } else if (current > 0) {
+                --current;
+            } else {
+                throw std::runtime_error("BWT: invalid code length");
+            }
+        }
+        if (current > kMaxCodeLength) {
+            throw std::runtime_error("BWT: invalid code length");
+        }
+        lengths[s] = static_cast<std::uint8_t>(current);
+    }
+
+    // 码长必须构成合法的前缀码（Kraft 和不超过 1），否则查表解码器可能越界
+    std::uint64_t kraft = 0;
+    for (unsigned s = 0; s < alphabet_size; ++s) {
+        if (lengths[s] != 0) {
+            kraft += std::uint64_t{1} << (kMaxCodeLength - lengths[s]);
+        }
+    }
+    if (kraft == 0 || kraft > (std::uint64_t{1} << kMaxCodeLength)) {
+        throw std::runtime_error("BWT: invalid code length table");
+    }
+    return lengths;
+}
+
+} // namespace
+
+void zero_run_huffman_encode(std::vector<Byte>& output, const Byte* mtf, std::size_t size) {
+    const auto symbols = zero_run_encode(mtf, size);
+    write_varint(output, symbols.size());
+    if (symbols.empty()) {
+        return;
+    }
+
+    unsigned alphabet_size = 0;
+    for (auto s : symbols) {
+        alphabet_size = std::max<unsigned>(alphabet_size, code_symbol(s) + 1u);
+    }
+    const TableSet set = optimize_tables(symbols, alphabet_size);
+
+    BitWriter writer(output);
+    writer.write(alphabet_size - 1, 8);
+    writer.write(set.lengths.size() - 1, 3);
+    for (const auto& lengths : set.lengths) {
+        write_lengths(writer, lengths, alphabet_size);
+    }
+
+    // 选表序号经 MTF 后以一元码写出：相邻分组常用同一张表
+    std::array<Byte, kBwtMaxTables> order{0, 1, 2, 3, 4, 5};
+    for (Byte selector : set.selectors) {
+        unsigned rank = 0;
+        while (order[rank] != selector) {
+            ++rank;
+        }
+        std::rotate(order.begin(), order.begin() + rank, order.begin() + rank + 1);
+        for (unsigned i = 0; i < rank; ++i) {
+            writer.write(1, 1);
+        }
+        writer.write(0, 1);
+    }
+
+    std::vector<std::array<std::uint64_t, 256>> codes;
+    for (const auto& lengths : set.lengths) {
+        codes.push_back(canonical_codes(lengths));
+    }
+    for (std::size_t i = 0; i < symbols.size(); ++i) {
+        const std::size_t table = set.selectors[i / kBwtGroupSize];
+        const Byte s = code_symbol(symbols[i]);
+        writer.write(codes[table][s], set.lengths[table][s]);
+        if (s == kEscape) {
+            writer.write(symbols[i] - kEscape, 1);
+        }
+    }
+    writer.finish();
+}
+
+void zero_run_huffman_decode(const Byte* data, const Byte* end, std::size_t count, std::vector<Byte>& mtf) {
+    const std::uint64_t symbol_count = read_varint(data, end);
+    // 每个符号至少对应一个 MTF 值
+    if (symbol_count > count || (symbol_count == 0 && count != 0)) {
+        throw std::runtime_error("BWT: invalid symbol count");
+    }
+    mtf.clear();
+    if (symbol_count == 0) {
+        return;
+    }
+    mtf.reserve(count);
+
+    BitReader reader(data, end);
+    const unsigned alphabet_size = reader.read(8) + 1;
+    const std::size_t table_count = reader.read(3) + 1;
+    if (table_count > kBwtMaxTables) {
+        throw std::runtime_error("BWT: invalid table count");
+    }
+    std::vector<HuffmanDecodeTable> tables;
+    tables.reserve(table_count);
+    for (std::size_t t = 0; t < table_count; ++t) {
+        const Lengths lengths = read_lengths(reader, alphabet_size);
+        tables.emplace_back(canonical_codes(lengths), lengths);
+    }
+
+    const std::size_t group_count = (symbol_count + kBwtGroupSize - 1) / kBwtGroupSize;
+    std::vector<Byte> selectors(group_count);
+    std::array<Byte, kBwtMaxTables> order{0, 1, 2, 3, 4, 5};
+    for (auto& selector : selectors) {
+        unsigned rank = 0;
+        for (;;) {
+            reader.refill();
+            if (reader.read(1) == 0) {
+                break;
+            }
+            if (++rank >= table_count) {
+                throw std::runtime_error("BWT: invalid table selector");
+            }
+        }
+        selector = order[rank];
+        std::rotate(order.begin(), order.begin() + rank, order.begin() + rank + 1);
+    }
+
+    // 连续的 RUNA/RUNB 累加为 0 游程：第 k 个数字贡献 (1 或 2) << k
+    std::size_t run = 0;
+    unsigned run_shift = 0;
+    auto flush_run = [&]() {
+        if (run > count - mtf.size()) {
+            throw std::runtime_error("BWT: zero run exceeds block size");
+        }
+        mtf.insert(mtf.end(), run, 0);
+        run = 0;
+        run_shift = 0;
+    };
+
+    for (std::size_t i = 0; i < symbol_count; ++i) {
+        const HuffmanDecodeTable& table = tables[selectors[i / kBwtGroupSize]];
+        reader.refill();
+        std::uint16_t s = table.decode(reader);
+        if (s == kRunA || s == kRunB) {
+            if (run_shift >= std::numeric_limits<std::size_t>::digits - 2) {
+                throw std::runtime_error("BWT: zero run exceeds block size");
+            }
+            run += static_cast<std::size_t>(s + 1) << run_shift++;
+            continue;
+        }
+        if (s == kEscape) {
+            s += static_cast<std::uint16_t>(reader.read(1));
+        }
+        flush_run();
+        if (mtf.size() == count) {
+            throw std::runtime_error("BWT: symbols exceed block size");
+        }
+        mtf.push_back(static_cast<Byte>(s - 1));
+    }
+    flush_run();
+
+    if (reader.bits_consumed() > static_cast<std::uint64_t>(end - data) * 8 || mtf.size() != count) {
+        throw std::runtime_error("BWT: truncated block");
+    }
+}
+
+} // namespace compressup
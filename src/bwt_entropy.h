@@ -0,0 +1,21 @@
+#pragma once
+
+#include "types.h"
+
+#include <cstddef>
+#include <vector>
+
+namespace compressup {
+
+// BWT+MTF 之后的 bzip2 式熵编码阶段：
+// 1. MTF 输出中的 0 游程用双射二进制数字 RUNA/RUNB 表示，其余值 v 记为符号 v + 1；
+// 2. 符号每 kBwtGroupSize 个为一组，每组从最多 kBwtMaxTables 张 Huffman 表中选用代价最小的一张，
+//    各表经数轮"分组选表 - 按所选分组重建码长"迭代得到。
+// 编码结果不含 MTF 长度，解码时由调用方给出；解码结果写入 mtf，复用其已有容量。
+constexpr std::size_t kBwtGroupSize = 50;
+constexpr std::size_t kBwtMaxTables = 6;
+
+void zero_run_huffman_encode(std::vector<Byte>& output, const Byte* mtf, std::size_t size);
+void zero_run_huffman_decode(const Byte* data, const Byte* end, std::size_t count, std::vector<Byte>& mtf);
+
+} // namespace compressup
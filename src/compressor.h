@@ -2,6 +2,8 @@
 
 #include "types.h"
 
+#include <cstdint>
+#include <memory>
 #include <string>
 #include <string_view>
 #include <vector>
@@ -15,6 +17,12 @@ public:
     virtual std::string name() const = 0;
     virtual std::vector<Byte> compress(std::string_view input) = 0;
     virtual std::string decompress(const std::vector<Byte>& input) = 0;
+
+    // 复制一个参数（压缩级别、流格式等）相同的压缩器，供并行包装器为每个块各建一个
+    virtual std::unique_ptr<ICompressor> clone() const = 0;
+
+    // 压缩输出的流格式版本，记录在容器头中以区分同一算法的不同流格式
+    virtual std::uint8_t format_version() const { return 1; }
 };
 
 } // namespace compressup
@@ -9,6 +9,10 @@ namespace {
 constexpr Byte kMagic = static_cast<Byte>(0xC3);
 constexpr std::size_t kHeaderSize = 1 + 1 + 8;
 
+// 带流格式版本的头部：magic + 算法 ID + 格式版本 + 原始长度
+constexpr Byte kVersionedMagic = static_cast<Byte>(0xC5);
+constexpr std::size_t kVersionedHeaderSize = 1 + 1 + 1 + 8;
+
 AlgorithmId to_algorithm_id(Byte value) {
     switch (static_cast<AlgorithmId>(value)) {
     case AlgorithmId::Rle:
@@ -25,6 +29,14 @@ AlgorithmId to_algorithm_id(Byte value) {
         return AlgorithmId::Delta;
     case AlgorithmId::Bwt:
         return AlgorithmId::Bwt;
+    case AlgorithmId::Lzh:
+        return AlgorithmId::Lzh;
+    case AlgorithmId::Range:
+        return AlgorithmId::Range;
+    case AlgorithmId::Fse:
+        return AlgorithmId::Fse;
+    case AlgorithmId::FseOrder1:
+        return AlgorithmId::FseOrder1;
     }
 
     throw std::runtime_error("Unknown algorithm id in container");
@@ -34,12 +46,23 @@ AlgorithmId to_algorithm_id(Byte value) {
 
 std::vector<Byte> pack_container(AlgorithmId algorithm,
                                  std::uint64_t original_size,
-                                 const std::vector<Byte>& compressed) {
-    std::vector<Byte> out;
-    out.reserve(kHeaderSize + compressed.size());
+                                 const std::vector<Byte>& compressed,
+                                 std::uint8_t format_version) {
+    if (format_version == 0) {
+        throw std::invalid_argument("Invalid container format version");
+    }
 
-    out.push_back(kMagic);
-    out.push_back(static_cast<Byte>(algorithm));
+    std::vector<Byte> out;
+    out.reserve(kVersionedHeaderSize + compressed.size());
+
+    if (format_version == 1) {
+        out.push_back(kMagic);
+        out.push_back(static_cast<Byte>(algorithm));
+    } else {
+        out.push_back(kVersionedMagic);
+        out.push_back(static_cast<Byte>(algorithm));
+        out.push_back(format_version);
+    }
 
     for (int i = 0; i < 8; ++i) {
         Byte b = static_cast<Byte>((original_size >> (i * 8)) & 0xFFu);
@@ -56,25 +79,38 @@ UnpackedContainer unpack_container(const std::vector<Byte>& data) {
         throw std::runtime_error("Container too small");
     }
 
-    if (data[0] != kMagic) {
+    std::size_t header_size = kHeaderSize;
+    std::uint8_t format_version = 1;
+    if (data[0] == kVersionedMagic) {
+        if (data.size() < kVersionedHeaderSize) {
+            throw std::runtime_error("Container too small");
+        }
+        header_size = kVersionedHeaderSize;
+        format_version = data[2];
+        if (format_version == 0) {
+            throw std::runtime_error("Invalid container format version");
+        }
+    } else if (data[0] != kMagic) {
         throw std::runtime_error("Invalid container magic");
     }
 
     Byte algo_byte = data[1];
     AlgorithmId algorithm = to_algorithm_id(algo_byte);
 
+    const std::size_t size_offset = header_size - 8;
     std::uint64_t original_size = 0;
     for (int i = 0; i < 8; ++i) {
-        original_size |= static_cast<std::uint64_t>(data[2 + i]) << (i * 8);
+        original_size |= static_cast<std::uint64_t>(data[size_offset + i]) << (i * 8);
     }
 
     std::vector<Byte> payload;
-    payload.insert(payload.end(), data.begin() + static_cast<std::ptrdiff_t>(kHeaderSize), data.end());
+    payload.insert(payload.end(), data.begin() + static_cast<std::ptrdiff_t>(header_size), data.end());
 
     UnpackedContainer result;
     result.algorithm = algorithm;
     result.original_size = original_size;
     result.payload = std::move(payload);
+    result.format_version = format_version;
 
     return result;
 }
@@ -11,16 +11,20 @@ namespace compressup {
 struct ContainerHeader {
     AlgorithmId algorithm;
     std::uint64_t original_size;
+    std::uint8_t format_version;
 };
 
+// format_version 为 1 时写出原有的头部格式，保证旧版本可读
 std::vector<Byte> pack_container(AlgorithmId algorithm,
                                  std::uint64_t original_size,
-                                 const std::vector<Byte>& compressed);
+                                 const std::vector<Byte>& compressed,
+                                 std::uint8_t format_version = 1);
 
 struct UnpackedContainer {
     AlgorithmId algorithm;
     std::uint64_t original_size;
     std::vector<Byte> payload;
+    std::uint8_t format_version;
 };
 
 UnpackedContainer unpack_container(const std::vector<Byte>& data);
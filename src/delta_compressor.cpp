@@ -8,6 +8,10 @@ std::string DeltaCompressor::name() const {
     return "delta";
 }
 
+std::unique_ptr<ICompressor> DeltaCompressor::clone() const {
+    return std::make_unique<DeltaCompressor>(*this);
+}
+
 std::vector<Byte> DeltaCompressor::compress(std::string_view input) {
     if (input.empty()) {
         return {};
@@ -9,6 +9,7 @@ namespace compressup {
 class DeltaCompressor : public ICompressor {
 public:
     std::string name() const override;
+    std::unique_ptr<ICompressor> clone() const override;
     std::vector<Byte> compress(std::string_view input) override;
     std::string decompress(const std::vector<Byte>& input) override;
 };
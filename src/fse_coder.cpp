@@ -0,0 +1,325 @@
+#include "fse_coder.h"
+
+#include "bit_stream.h"
+#include "varint.h"
+
+#include <algorithm>
+#include <bit>
+#include <stdexcept>
+
+namespace compressup {
+
+namespace {
+
+// 把符号分散到状态表中：步长与表大小互素，同一符号的状态尽量均匀分布
+std::vector<Byte> spread_symbols(const FseCounts& counts, unsigned table_log) {
+    const std::size_t table_size = std::size_t{1} << table_log;
+    const std::size_t mask = table_size - 1;
+    const std::size_t step = (table_size >> 1) + (table_size >> 3) + 3;
+
+    std::vector<Byte> symbols(table_size);
+    std::size_t pos = 0;
+    for (int s = 0; s < 256; ++s) {
+        for (unsigned i = 0; i < counts[s]; ++i) {
+            symbols[pos] = static_cast<Byte>(s);
+            pos = (pos + step) & mask;
+        }
+    }
+    return symbols;
+}
+
+unsigned highest_bit(std::uint32_t value) {
+    return static_cast<unsigned>(std::bit_width(value)) - 1;
+}
+
+} // namespace
+
+unsigned fse_table_log(std::size_t total, std::size_t symbol_count) {
+    // 状态数约为输入长度的 1/4 时表头开销与精度损失比较均衡
+    unsigned log = static_cast<unsigned>(std::bit_width(total));
+    log = log > 2 ? log - 2 : 0;
+    log = std::max(log, static_cast<unsigned>(std::bit_width(symbol_count - 1)) + 1);
+    return std::clamp(log, kFseMinTableLog, kFseMaxTableLog);
+}
+
+FseCounts normalize_counts(const ByteHistogram& counts, std::size_t total, unsigned table_log) {
+    const std::uint64_t table_size = std::uint64_t{1} << table_log;
+    FseCounts normalized{};
+
+    // 先按比例向下取整（出现过的符号至少为 1），再按余数从大到小补足差额
+    std::array<std::uint64_t, 256> remainders{};
+    std::uint64_t sum = 0;
+    for (int s = 0; s < 256; ++s) {
+        if (counts[s] == 0) {
+            continue;
+        }
+        const std::uint64_t scaled = counts[s] * table_size;
+        const std::uint64_t value = std::max<std::uint64_t>(scaled / total, 1);
+        normalized[s] = static_cast<std::uint16_t>(value);
+        remainders[s] = value * total >= scaled ? 0 : scaled - value * total;
+        sum += value;
+    }
+
+    if (sum < table_size) {
+        std::vector<int> order;
+        for (int s = 0; s < 256; ++s) {
+            if (counts[s] != 0) {
+                order.push_back(s);
+            }
+        }
+        std::stable_sort(order.begin(), order.end(),
+                         [&](int a, int b) { return remainders[a] > remainders[b]; });
+        // 差额小于符号数，一轮即可补足
+        for (std::size_t i = 0; sum < table_size; ++i, ++sum) {
+            ++normalized[order[i % order.size()]];
+        }
+    }
+
+    // 强制为 1 的小概率符号可能使总和超出，从计数最大的符号中扣除
+    while (sum > table_size) {
+        const auto largest = std::max_element(normalized.begin(), normalized.end());
+        --*largest;
+        --sum;
+    }
+    return normalized;
+}
+
+void write_fse_counts(std::vector<Byte>& output, const FseCounts& counts, unsigned table_log) {
+    output.push_back(static_cast<Byte>(table_log));
+
+    int last = 255;
+    while (last > 0 && counts[last] == 0) {
+        --last;
+    }
+    for (int s = 0; s <= last;) {
+        write_varint(output, counts[s]);
+        if (counts[s] != 0) {
+            ++s;
+            continue;
+        }
+        int run = 1;
+        while (s + run <= last && counts[s + run] == 0 && run < 256) {
+            ++run;
+        }
+        output.push_back(static_cast<Byte>(run - 1));
+        s += run;
+    }
+}
+
+unsigned read_fse_counts(const Byte*& data, const Byte* end, FseCounts& counts) {
+    if (data >= end) {
+        throw std::runtime_error("FSE: truncated table header");
+    }
+    const unsigned table_log = *data++;
+    if (table_log < kFseMinTableLog || table_log > kFseMaxTableLog) {
+        throw std::runtime_error("FSE: invalid table log");
+    }
+
+    // 计数之和达到表大小即结束，其余符号为 0
+    const std::uint64_t table_size = std::uint64_t{1} << table_log;
+    counts.fill(0);
+    std::uint64_t sum = 0;
+    int s = 0;
+    while (sum < table_size) {
+        if (s > 255) {
+            throw std::runtime_error("FSE: invalid table header");
+        }
+        const std::uint64_t count = read_varint(data, end);
+        if (count > table_size - sum) {
+            throw std::runtime_error("FSE: invalid table header");
+        }
+        if (count == 0) {
+            if (data >= end) {
+                throw std::runtime_error("FSE: truncated table header");
+            }
+            s += 1 + *data++;
+            continue;
+        }
+        counts[s++] = static_cast<std::uint16_t>(count);
+        sum += count;
+    }
+    return table_log;
+}
+
+FseEncodeTable::FseEncodeTable(const FseCounts& counts, unsigned table_log)
+    : FseEncodeTable(std::vector<FseCounts>{counts}, table_log) {
+}
+
+FseEncodeTable::FseEncodeTable(const std::vector<FseCounts>& tables, unsigned table_log)
+    : table_log_(table_log)
+    , table_count_(tables.size())
+    , state_table_(tables.size() << table_log)
+    , transforms_(tables.size() * 256) {
+    const std::uint32_t table_size = std::uint32_t{1} << table_log;
+
+    for (std::size_t t = 0; t < tables.size(); ++t) {
+        const FseCounts& counts = tables[t];
+        const auto symbols = spread_symbols(counts, table_log);
+        const auto offset = static_cast<std::uint32_t>(t << table_log);
+
+        std::array<std::uint32_t, 256> next{};
+        std::uint32_t cumulative = offset;
+        for (int s = 0; s < 256; ++s) {
+            next[s] = cumulative;
+            const std::uint32_t count = counts[s];
+            if (count != 0) {
+                // 状态 x 编码该符号时输出 max_bits 或 max_bits - 1 位，使 x >> 位数 落在 [count, 2 * count)
+                const unsigned max_bits = table_log - (count == 1 ? 0 : highest_bit(count - 1));
+                SymbolTransform& transform = transforms_[t * 256 + s];
+                transform.delta_nb_bits = (max_bits << 16) - (count << max_bits);
+                transform.delta_find_state = static_cast<std::int32_t>(cumulative) -
+                                             static_cast<std::int32_t>(count);
+            }
+            cumulative += count;
+        }
+
+        // 每个符号按状态位置升序排列其状态，与解码表的编号顺序一致
+        for (std::uint32_t u = 0; u < table_size; ++u) {
+            state_table_[next[symbols[u]]++] = static_cast<std::uint16_t>(table_size + u);
+        }
+    }
+}
+
+template <typename SelectTable>
+void FseEncodeTable::encode_with(std::vector<Byte>& output, const Byte* symbols, std::size_t size,
+                                 SelectTable select_table) const {
+    const std::uint32_t table_size = std::uint32_t{1} << table_log_;
+
+    // 两个状态交替编码偶数与奇数位置的符号，解码时两条依赖链可以重叠执行。
+    // 编码器逆序处理，先记录每个符号输出的比特，再按解码顺序写出
+    std::vector<std::uint32_t> bits(size);
+    std::uint32_t states[2] = {table_size, table_size};
+    for (std::size_t i = size; i-- > 0;) {
+        std::uint32_t& state = states[i & 1];
+        const SymbolTransform& transform = transforms_[select_table(i) * 256 + symbols[i]];
+        const std::uint32_t nb_bits = (state + transform.delta_nb_bits) >> 16;
+        bits[i] = ((state & ((std::uint32_t{1} << nb_bits) - 1)) << 8) | nb_bits;
+        state = state_table_[static_cast<std::int32_t>(state >> nb_bits) + transform.delta_find_state];
+    }
+
+    output.reserve(output.size() + size / 2 + 8);
+    BitWriter writer(output);
+    writer.write(states[0] - table_size, table_log_);
+    writer.write(states[1] - table_size, table_log_);
+    // 每次合并 4 个符号的比特（最多 4 * table_log 位）再写入
+    std::size_t i = 0;
+    for (; i + 4 <= size; i += 4) {
+        std::uint64_t code = 0;
+        unsigned length = 0;
+        for (std::size_t k = i; k < i + 4; ++k) {
+            const unsigned nb_bits = bits[k] & 0xFF;
+            code = (code << nb_bits) | (bits[k] >> 8);
+            length += nb_bits;
+        }
+        if (length != 0) {
+            writer.write(code, length);
+        }
+    }
+    for (; i < size; ++i) {
+        const unsigned nb_bits = bits[i] & 0xFF;
+        if (nb_bits != 0) {
+            writer.write(bits[i] >> 8, nb_bits);
+        }
+    }
+    writer.finish();
+}
+
+void FseEncodeTable::encode(std::vector<Byte>& output, const Byte* symbols, std::size_t size) const {
+    encode_with(output, symbols, size, [](std::size_t) { return std::size_t{0}; });
+}
+
+void FseEncodeTable::encode_order1(std::vector<Byte>& output, const Byte* symbols, std::size_t size,
+                                   const FseContextMap& table_of_context) const {
+    for (std::uint16_t t : table_of_context) {
+        if (t >= table_count_) {
+            throw std::invalid_argument("FSE: context mapped to a missing table");
+        }
+    }
+    encode_with(output, symbols, size, [&](std::size_t i) -> std::size_t {
+        return table_of_context[i == 0 ? 0 : symbols[i - 1]];
+    });
+}
+
+FseDecodeTable::FseDecodeTable(const FseCounts& counts, unsigned table_log)
+    : FseDecodeTable(std::vector<FseCounts>{counts}, table_log) {
+}
+
+FseDecodeTable::FseDecodeTable(const std::vector<FseCounts>& tables, unsigned table_log)
+    : table_log_(table_log)
+    , table_count_(tables.size())
+    , entries_(tables.size() << table_log) {
+    const std::uint32_t table_size = std::uint32_t{1} << table_log;
+
+    for (std::size_t t = 0; t < tables.size(); ++t) {
+        const FseCounts& counts = tables[t];
+        const auto symbols = spread_symbols(counts, table_log);
+        Entry* entries = entries_.data() + (t << table_log);
+
+        std::array<std::uint32_t, 256> next{};
+        for (int s = 0; s < 256; ++s) {
+            next[s] = counts[s];
+        }
+        for (std::uint32_t u = 0; u < table_size; ++u) {
+            const Byte symbol = symbols[u];
+            const std::uint32_t x = next[symbol]++;  // [count, 2 * count)
+            const unsigned nb_bits = table_log - highest_bit(x);
+            entries[u] = {static_cast<std::uint16_t>((x << nb_bits) - table_size), symbol,
+                          static_cast<std::uint8_t>(nb_bits)};
+        }
+    }
+}
+
+template <typename SelectTable>
+void FseDecodeTable::decode_with(const Byte* data, const Byte* end, Byte* output, std::size_t count,
+                                 const Entry* table, SelectTable select_table) const {
+    BitReader reader(data, end);
+    std::uint32_t state0 = reader.read(table_log_);
+    std::uint32_t state1 = reader.read(table_log_);
+
+    // 当前表保存在寄存器中，由刚解出的符号选出下一个符号的表
+    auto step = [&](std::uint32_t& state, std::size_t i) {
+        const Entry entry = table[state];
+        output[i] = entry.symbol;
+        table = select_table(entry.symbol);
+        state = entry.base + reader.read(entry.nb_bits);
+    };
+
+    // 每个符号最多读 table_log 位，一次补充缓冲区足够解码 4 个符号
+    static_assert(4 * kFseMaxTableLog <= BitReader::kMinBits);
+    std::size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        reader.refill();
+        step(state0, i);
+        step(state1, i + 1);
+        step(state0, i + 2);
+        step(state1, i + 3);
+    }
+    for (; i < count; ++i) {
+        reader.refill();
+        step((i & 1) ? state1 : state0, i);
+    }
+
+    if (reader.bits_consumed() > static_cast<std::uint64_t>(end - data) * 8) {
+        throw std::runtime_error("FSE: truncated bitstream");
+    }
+}
+
+void FseDecodeTable::decode(const Byte* data, const Byte* end, Byte* output, std::size_t count) const {
+    const Entry* entries = entries_.data();
+    decode_with(data, end, output, count, entries, [entries](Byte) { return entries; });
+}
+
+void FseDecodeTable::decode_order1(const Byte* data, const Byte* end, Byte* output, std::size_t count,
+                                   const FseContextMap& table_of_context) const {
+    // 上下文直接映射到表的起始地址，解码时只多一次按前一字节的查表
+    std::array<const Entry*, 256> tables{};
+    for (int c = 0; c < 256; ++c) {
+        if (table_of_context[c] >= table_count_) {
+            throw std::runtime_error("FSE: context mapped to a missing table");
+        }
+        tables[c] = entries_.data() + (std::size_t{table_of_context[c]} << table_log_);
+    }
+    decode_with(data, end, output, count, tables[0], [&tables](Byte symbol) { return tables[symbol]; });
+}
+
+} // namespace compressup
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "histogram.h"
+#include "types.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace compressup {
+
+// 表驱动的非对称数字系统（tANS，FSE 式实现）
+// 每个出现过的符号分得 normalized[s] 个状态（总数 2^table_log），符号概率近似为
+// normalized[s] / 2^table_log。编码器逆序处理输入，解码器正序读取，每个符号只需
+// 一次查表与一次读比特。
+
+// 归一化后的符号计数，和为 2^table_log，出现过的符号至少为 1
+using FseCounts = std::array<std::uint16_t, 256>;
+
+constexpr unsigned kFseMinTableLog = 5;
+constexpr unsigned kFseMaxTableLog = 11;
+
+// 按输入长度与符号数选择表大小：短输入用小表以减小表头，符号数必须不超过表大小
+unsigned fse_table_log(std::size_t total, std::size_t symbol_count);
+
+// 把直方图缩放到和为 2^table_log；total 为直方图计数之和
+FseCounts normalize_counts(const ByteHistogram& counts, std::size_t total, unsigned table_log);
+
+// 计数表的序列化：[table_log][varint 计数...]，计数 0 之后跟一个字节表示额外的 0 的个数
+void write_fse_counts(std::vector<Byte>& output, const FseCounts& counts, unsigned table_log);
+// 读取并校验计数表（和必须为 2^table_log），返回 table_log
+unsigned read_fse_counts(const Byte*& data, const Byte* end, FseCounts& counts);
+
+// 上下文到表序号的映射（order-1 模式下按前一字节选表）
+using FseContextMap = std::array<std::uint16_t, 256>;
+
+// 编码表。可以一次构造多张共用同一 table_log 的表，存放在同一块存储中：所有表的状态
+// 取值范围相同，同一个状态可以在表之间切换，因此每个符号可以用不同的表编码。
+class FseEncodeTable {
+public:
+    FseEncodeTable(const FseCounts& counts, unsigned table_log);
+    FseEncodeTable(const std::vector<FseCounts>& tables, unsigned table_log);
+
+    // 用第 0 张表编码 symbols[0..size) 并写出比特流（调用方保证所有符号的计数非 0）
+    void encode(std::vector<Byte>& output, const Byte* symbols, std::size_t size) const;
+
+    // order-1：第 i 个符号用 table_of_context[symbols[i - 1]] 号表编码，第 0 个符号的上下文为 0
+    void encode_order1(std::vector<Byte>& output, const Byte* symbols, std::size_t size,
+                       const FseContextMap& table_of_context) const;
+
+private:
+    struct SymbolTransform {
+        std::int32_t delta_find_state;  // 表偏移 + cumulative[s] - counts[s]
+        std::uint32_t delta_nb_bits;    // (最大输出位数 << 16) - (counts[s] << 最大输出位数)
+    };
+
+    template <typename SelectTable>
+    void encode_with(std::vector<Byte>& output, const Byte* symbols, std::size_t size,
+                     SelectTable select_table) const;
+
+    unsigned table_log_;
+    std::size_t table_count_;
+    std::vector<std::uint16_t> state_table_;    // 各表按符号分组的下一状态（取值 [2^L, 2^(L+1))）
+    std::vector<SymbolTransform> transforms_;   // [表序号 * 256 + 符号]
+};
+
+class FseDecodeTable {
+public:
+    FseDecodeTable(const FseCounts& counts, unsigned table_log);
+    FseDecodeTable(const std::vector<FseCounts>& tables, unsigned table_log);
+
+    // 解码 count 个符号到 output，比特流越过 [data, end) 时抛出异常
+    void decode(const Byte* data, const Byte* end, Byte* output, std::size_t count) const;
+
+    // 与 encode_order1 对应：按已解码的前一字节选表
+    void decode_order1(const Byte* data, const Byte* end, Byte* output, std::size_t count,
+                       const FseContextMap& table_of_context) const;
+
+private:
+    struct Entry {
+        std::uint16_t base;    // 新状态 = base + 读出的 nb_bits 位
+        Byte symbol;
+        std::uint8_t nb_bits;
+    };
+
+    template <typename SelectTable>
+    void decode_with(const Byte* data, const Byte* end, Byte* output, std::size_t count,
+                     const Entry* table, SelectTable select_table) const;
+
+    unsigned table_log_;
+    std::size_t table_count_;
+    std::vector<Entry> entries_;  // [表序号 * 2^L + 状态]
+};
+
+} // namespace compressup
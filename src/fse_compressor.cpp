@@ -0,0 +1,130 @@
+#include "fse_compressor.h"
+
+#include "fse_coder.h"
+#include "histogram.h"
+#include "varint.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace compressup {
+
+namespace {
+
+// 块模式
+constexpr Byte kModeSingleSymbol = 0;  // 只有一种符号：[符号]
+constexpr Byte kModeCompressed = 1;    // [计数表][varint 比特流长度][比特流]
+constexpr Byte kModeRaw = 2;           // 编码后不比原数据小：[原始字节]
+
+} // namespace
+
+std::string FseCompressor::name() const {
+    return "fse";
+}
+
+std::unique_ptr<ICompressor> FseCompressor::clone() const {
+    return std::make_unique<FseCompressor>(*this);
+}
+
+std::vector<Byte> FseCompressor::compress(std::string_view input) {
+    if (input.empty()) {
+        return {};
+    }
+
+    // 格式：[varint 原始长度]，随后每 kBlockSize 字节一块：[模式][块数据]
+    std::vector<Byte> output;
+    output.reserve(input.size() / 2 + 16);
+    write_varint(output, input.size());
+
+    std::vector<Byte> bitstream;
+    for (std::size_t pos = 0; pos < input.size(); pos += kBlockSize) {
+        const std::string_view block = input.substr(pos, kBlockSize);
+        const auto* bytes = reinterpret_cast<const Byte*>(block.data());
+
+        const ByteHistogram histogram = byte_histogram(block);
+        const auto symbol_count = static_cast<std::size_t>(
+            std::count_if(histogram.begin(), histogram.end(), [](std::size_t c) { return c != 0; }));
+        if (symbol_count == 1) {
+            output.push_back(kModeSingleSymbol);
+            output.push_back(bytes[0]);
+            continue;
+        }
+
+        const unsigned table_log = fse_table_log(block.size(), symbol_count);
+        const FseCounts counts = normalize_counts(histogram, block.size(), table_log);
+
+        const std::size_t block_start = output.size();
+        output.push_back(kModeCompressed);
+        write_fse_counts(output, counts, table_log);
+        bitstream.clear();
+        FseEncodeTable(counts, table_log).encode(bitstream, bytes, block.size());
+        write_varint(output, bitstream.size());
+
+        if (output.size() - block_start + bitstream.size() >= block.size() + 1) {
+            // 接近均匀分布的数据直接存储
+            output.resize(block_start);
+            output.push_back(kModeRaw);
+            output.insert(output.end(), bytes, bytes + block.size());
+        } else {
+            output.insert(output.end(), bitstream.begin(), bitstream.end());
+        }
+    }
+    return output;
+}
+
+std::string FseCompressor::decompress(const std::vector<Byte>& input) {
+    if (input.empty()) {
+        return {};
+    }
+
+    const Byte* data = input.data();
+    const Byte* end = data + input.size();
+    const std::uint64_t orig_len = read_varint(data, end);
+    // 每块至少占 2 字节（模式 + 符号）：原始长度来自流头，块数超过载荷所能容纳的流必然损坏，
+    // 在分配输出之前拒绝
+    const std::uint64_t block_count = orig_len / kBlockSize + (orig_len % kBlockSize != 0);
+    if (block_count > static_cast<std::uint64_t>(end - data) / 2) {
+        throw std::runtime_error("FSE: original length exceeds payload");
+    }
+
+    std::string output(orig_len, '\0');
+    auto* out = reinterpret_cast<Byte*>(output.data());
+    for (std::uint64_t pos = 0; pos < orig_len; pos += kBlockSize) {
+        const auto block_size = static_cast<std::size_t>(std::min<std::uint64_t>(kBlockSize, orig_len - pos));
+        if (data >= end) {
+            throw std::runtime_error("FSE: truncated input");
+        }
+
+        switch (*data++) {
+        case kModeSingleSymbol:
+            if (data >= end) {
+                throw std::runtime_error("FSE: truncated input");
+            }
+            std::fill_n(out + pos, block_size, *data++);
+            break;
+        case kModeCompressed: {
+            FseCounts counts;
+            const unsigned table_log = read_fse_counts(data, end, counts);
+            const std::uint64_t stream_size = read_varint(data, end);
+            if (stream_size > static_cast<std::uint64_t>(end - data)) {
+                throw std::runtime_error("FSE: truncated input");
+            }
+            FseDecodeTable(counts, table_log).decode(data, data + stream_size, out + pos, block_size);
+            data += stream_size;
+            break;
+        }
+        case kModeRaw:
+            if (static_cast<std::size_t>(end - data) < block_size) {
+                throw std::runtime_error("FSE: truncated input");
+            }
+            std::copy_n(data, block_size, out + pos);
+            data += block_size;
+            break;
+        default:
+            throw std::runtime_error("FSE: invalid block mode");
+        }
+    }
+    return output;
+}
+
+} // namespace compressup
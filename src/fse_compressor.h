@@ -0,0 +1,20 @@
+#pragma once
+
+#include "compressor.h"
+
+namespace compressup {
+
+// FSE：表驱动的 tANS 熵编码
+// 压缩率接近算术编码，解码每符号一次查表、无分支，速度与查表 Huffman 相当。
+// 输入按块处理，每块统计直方图并各自建表，适应分布的局部变化。
+class FseCompressor : public ICompressor {
+public:
+    std::string name() const override;
+    std::unique_ptr<ICompressor> clone() const override;
+    std::vector<Byte> compress(std::string_view input) override;
+    std::string decompress(const std::vector<Byte>& input) override;
+
+    static constexpr std::size_t kBlockSize = 128 * 1024;
+};
+
+} // namespace compressup
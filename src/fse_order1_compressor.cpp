@@ -0,0 +1,229 @@
+#include "fse_order1_compressor.h"
+
+#include "fse_coder.h"
+#include "varint.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace compressup {
+
+namespace {
+
+// 块模式
+constexpr Byte kModeCompressed = 1;  // [表头][varint 比特流长度][比特流]
+constexpr Byte kModeRaw = 2;         // 编码后不比原数据小：[原始字节]
+
+// 按给定概率分布编码一组计数所需的比特数
+double coded_bits(const ByteHistogram& counts, const ByteHistogram& model, std::size_t model_total) {
+    double bits = 0;
+    for (int s = 0; s < 256; ++s) {
+        if (counts[s] != 0) {
+            bits += static_cast<double>(counts[s]) *
+                    std::log2(static_cast<double>(model_total) / static_cast<double>(model[s]));
+        }
+    }
+    return bits;
+}
+
+} // namespace
+
+std::string FseOrder1Compressor::name() const {
+    return "fse-o1";
+}
+
+std::unique_ptr<ICompressor> FseOrder1Compressor::clone() const {
+    return std::make_unique<FseOrder1Compressor>(*this);
+}
+
+std::vector<Byte> FseOrder1Compressor::compress(std::string_view input) {
+    if (input.empty()) {
+        return {};
+    }
+
+    // 格式：[varint 原始长度]，随后每 kBlockSize 字节一块：[模式][块数据]
+    // 压缩块的表头：[table_log][上下文位图 32 字节][是否有回退表][回退表计数][各上下文表计数]
+    std::vector<Byte> output;
+    output.reserve(input.size() / 2 + 16);
+    write_varint(output, input.size());
+
+    std::vector<ByteHistogram> contexts(256);
+    std::vector<Byte> scratch;
+    std::vector<Byte> bitstream;
+    for (std::size_t pos = 0; pos < input.size(); pos += kBlockSize) {
+        const std::string_view block = input.substr(pos, kBlockSize);
+        const auto* bytes = reinterpret_cast<const Byte*>(block.data());
+
+        // 每块的第一个字节以 0 为上下文，块之间互不依赖
+        for (auto& histogram : contexts) {
+            histogram.fill(0);
+        }
+        ByteHistogram order0{};
+        Byte prev = 0;
+        for (Byte b : std::string_view(block)) {
+            ++contexts[prev][b];
+            ++order0[b];
+            prev = b;
+        }
+        const auto symbol_count = static_cast<std::size_t>(
+            std::count_if(order0.begin(), order0.end(), [](std::size_t c) { return c != 0; }));
+        const unsigned table_log = std::min(kMaxTableLog, fse_table_log(block.size(), symbol_count));
+
+        // 单独建表节省的比特数（相对 order-0 分布）超过表头开销的上下文才建表
+        std::array<bool, 256> own{};
+        ByteHistogram fallback{};
+        std::size_t fallback_total = 0;
+        std::vector<FseCounts> tables;
+        std::vector<Byte> own_headers;
+        for (int c = 0; c < 256; ++c) {
+            std::size_t total = 0;
+            for (std::size_t count : contexts[c]) {
+                total += count;
+            }
+            if (total == 0) {
+                continue;
+            }
+
+            const FseCounts counts = normalize_counts(contexts[c], total, table_log);
+            scratch.clear();
+            write_fse_counts(scratch, counts, table_log);
+            const double own_bits = coded_bits(contexts[c], contexts[c], total) +
+                                    static_cast<double>(scratch.size()) * 8;
+            if (own_bits < coded_bits(contexts[c], order0, block.size())) {
+                own[c] = true;
+                tables.push_back(counts);
+                own_headers.insert(own_headers.end(), scratch.begin(), scratch.end());
+            } else {
+                for (int s = 0; s < 256; ++s) {
+                    fallback[s] += contexts[c][s];
+                }
+                fallback_total += total;
+            }
+        }
+
+        // 回退表为 0 号表，其余表按上下文升序编号
+        FseContextMap table_of_context{};
+        const std::uint16_t first_own = fallback_total != 0 ? 1 : 0;
+        std::uint16_t next_table = first_own;
+        for (int c = 0; c < 256; ++c) {
+            if (own[c]) {
+                table_of_context[c] = next_table++;
+            }
+        }
+        if (fallback_total != 0) {
+            tables.insert(tables.begin(), normalize_counts(fallback, fallback_total, table_log));
+        }
+
+        const std::size_t block_start = output.size();
+        output.push_back(kModeCompressed);
+        output.push_back(static_cast<Byte>(table_log));
+        for (int c = 0; c < 256; c += 8) {
+            Byte bits = 0;
+            for (int k = 0; k < 8; ++k) {
+                bits |= static_cast<Byte>(own[c + k]) << k;
+            }
+            output.push_back(bits);
+        }
+        output.push_back(static_cast<Byte>(first_own));
+        if (first_own != 0) {
+            write_fse_counts(output, tables[0], table_log);
+        }
+        output.insert(output.end(), own_headers.begin(), own_headers.end());
+
+        bitstream.clear();
+        FseEncodeTable(tables, table_log).encode_order1(bitstream, bytes, block.size(), table_of_context);
+        write_varint(output, bitstream.size());
+
+        if (output.size() - block_start + bitstream.size() >= block.size() + 1) {
+            output.resize(block_start);
+            output.push_back(kModeRaw);
+            output.insert(output.end(), bytes, bytes + block.size());
+        } else {
+            output.insert(output.end(), bitstream.begin(), bitstream.end());
+        }
+    }
+    return output;
+}
+
+std::string FseOrder1Compressor::decompress(const std::vector<Byte>& input) {
+    if (input.empty()) {
+        return {};
+    }
+
+    const Byte* data = input.data();
+    const Byte* end = data + input.size();
+    const std::uint64_t orig_len = read_varint(data, end);
+    // 整块至少占 35 字节（模式、表位数、上下文位图与回退标志），末尾的短块至少 2 字节：
+    // 原始长度来自流头，块数超过载荷所能容纳的流必然损坏，在分配输出之前拒绝
+    constexpr std::uint64_t kMinFullBlockBytes = 35;
+    const std::uint64_t full_blocks = orig_len / kBlockSize;
+    const std::uint64_t payload = static_cast<std::uint64_t>(end - data);
+    if (full_blocks > payload / kMinFullBlockBytes ||
+        full_blocks * kMinFullBlockBytes + (orig_len % kBlockSize != 0 ? 2 : 0) > payload) {
+        throw std::runtime_error("FSE-O1: original length exceeds payload");
+    }
+
+    std::string output(orig_len, '\0');
+    auto* out = reinterpret_cast<Byte*>(output.data());
+    for (std::uint64_t pos = 0; pos < orig_len; pos += kBlockSize) {
+        const auto block_size = static_cast<std::size_t>(std::min<std::uint64_t>(kBlockSize, orig_len - pos));
+        if (data >= end) {
+            throw std::runtime_error("FSE-O1: truncated input");
+        }
+
+        const Byte mode = *data++;
+        if (mode == kModeRaw) {
+            if (static_cast<std::size_t>(end - data) < block_size) {
+                throw std::runtime_error("FSE-O1: truncated input");
+            }
+            std::copy_n(data, block_size, out + pos);
+            data += block_size;
+            continue;
+        }
+        if (mode != kModeCompressed) {
+            throw std::runtime_error("FSE-O1: invalid block mode");
+        }
+
+        if (end - data < 34) {
+            throw std::runtime_error("FSE-O1: truncated input");
+        }
+        const unsigned table_log = *data++;
+        const Byte* bitmap = data;
+        data += 32;
+        const bool has_fallback = *data++ != 0;
+
+        std::vector<FseCounts> tables;
+        auto read_table = [&]() {
+            FseCounts counts;
+            if (read_fse_counts(data, end, counts) != table_log) {
+                throw std::runtime_error("FSE-O1: inconsistent table log");
+            }
+            tables.push_back(counts);
+        };
+        if (has_fallback) {
+            read_table();
+        }
+        FseContextMap table_of_context{};
+        for (int c = 0; c < 256; ++c) {
+            if ((bitmap[c / 8] >> (c % 8)) & 1) {
+                table_of_context[c] = static_cast<std::uint16_t>(tables.size());
+                read_table();
+            }
+        }
+        if (tables.empty()) {
+            throw std::runtime_error("FSE-O1: block without tables");
+        }
+
+        const std::uint64_t stream_size = read_varint(data, end);
+        if (stream_size > static_cast<std::uint64_t>(end - data)) {
+            throw std::runtime_error("FSE-O1: truncated input");
+        }
+        FseDecodeTable(tables, table_log)
+            .decode_order1(data, data + stream_size, out + pos, block_size, table_of_context);
+        data += stream_size;
+    }
+    return output;
+}
+
+} // namespace compressup
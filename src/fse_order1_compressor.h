@@ -0,0 +1,24 @@
+#pragma once
+
+#include "compressor.h"
+
+namespace compressup {
+
+// order-1 上下文模型的 tANS 熵编码
+// 以前一字节为上下文，每个上下文一张 FSE 表，捕捉文本与结构化日志中相邻字节的相关性。
+// 所有表共用同一 table_log 与一块连续存储，编解码状态可在表之间直接切换；出现次数少、
+// 单独建表得不偿失的上下文共用一张回退表。
+class FseOrder1Compressor : public ICompressor {
+public:
+    std::string name() const override;
+    std::unique_ptr<ICompressor> clone() const override;
+    std::vector<Byte> compress(std::string_view input) override;
+    std::string decompress(const std::vector<Byte>& input) override;
+
+    // 块越大每张表分摊的表头越少，但表需要适应的分布也越杂
+    static constexpr std::size_t kBlockSize = 1024 * 1024;
+    // 上下文表的最大 table_log：表多时较小的表更容易留在缓存中
+    static constexpr unsigned kMaxTableLog = 10;
+};
+
+} // namespace compressup
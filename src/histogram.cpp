@@ -0,0 +1,105 @@
+#include "histogram.h"
+
+#include "parallel_compressor.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <future>
+#include <thread>
+#include <vector>
+
+namespace compressup {
+
+namespace {
+
+constexpr std::size_t kSubTables = 4;
+
+// 每轮最多统计的字节数，保证 32 位子表计数不会溢出
+constexpr std::size_t kMaxRound = std::size_t{1} << 30;
+
+void count_round(const Byte* data, std::size_t size, ByteHistogram& result) {
+    std::uint32_t tables[kSubTables][256] = {};
+
+    const Byte* p = data;
+    const Byte* const end = data + size;
+
+    // 每次读入 16 字节，按字节位置轮流使用 4 张子表
+    while (end - p >= 16) {
+        std::uint64_t w0;
+        std::uint64_t w1;
+        std::memcpy(&w0, p, 8);
+        std::memcpy(&w1, p + 8, 8);
+        p += 16;
+
+        for (int i = 0; i < 8; i += 4) {
+            ++tables[0][(w0 >> (8 * i)) & 0xFF];
+            ++tables[1][(w0 >> (8 * i + 8)) & 0xFF];
+            ++tables[2][(w0 >> (8 * i + 16)) & 0xFF];
+            ++tables[3][(w0 >> (8 * i + 24)) & 0xFF];
+        }
+        for (int i = 0; i < 8; i += 4) {
+            ++tables[0][(w1 >> (8 * i)) & 0xFF];
+            ++tables[1][(w1 >> (8 * i + 8)) & 0xFF];
+            ++tables[2][(w1 >> (8 * i + 16)) & 0xFF];
+            ++tables[3][(w1 >> (8 * i + 24)) & 0xFF];
+        }
+    }
+    while (p < end) {
+        ++tables[0][*p++];
+    }
+
+    for (std::size_t b = 0; b < 256; ++b) {
+        result[b] += static_cast<std::size_t>(tables[0][b]) + tables[1][b] + tables[2][b] + tables[3][b];
+    }
+}
+
+ByteHistogram count_range(const Byte* data, std::size_t size) {
+    ByteHistogram result{};
+    for (std::size_t offset = 0; offset < size; offset += kMaxRound) {
+        count_round(data + offset, std::min(kMaxRound, size - offset), result);
+    }
+    return result;
+}
+
+} // namespace
+
+ByteHistogram byte_histogram(std::string_view input) {
+    return count_range(reinterpret_cast<const Byte*>(input.data()), input.size());
+}
+
+ByteHistogram byte_histogram_parallel(std::string_view input,
+                                      std::size_t num_threads,
+                                      std::size_t min_chunk) {
+    if (num_threads == 0) {
+        num_threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    min_chunk = std::max<std::size_t>(min_chunk, 1);
+
+    const std::size_t chunks = std::min(num_threads, input.size() / min_chunk);
+    if (chunks < 2) {
+        return byte_histogram(input);
+    }
+
+    const Byte* data = reinterpret_cast<const Byte*>(input.data());
+    const std::size_t chunk_size = (input.size() + chunks - 1) / chunks;
+
+    ThreadPool pool(chunks);
+    std::vector<std::future<ByteHistogram>> futures;
+    futures.reserve(chunks);
+    for (std::size_t offset = 0; offset < input.size(); offset += chunk_size) {
+        const std::size_t size = std::min(chunk_size, input.size() - offset);
+        futures.push_back(pool.submit(count_range, data + offset, size));
+    }
+
+    ByteHistogram result{};
+    for (auto& future : futures) {
+        const ByteHistogram partial = future.get();
+        for (std::size_t b = 0; b < 256; ++b) {
+            result[b] += partial[b];
+        }
+    }
+    return result;
+}
+
+} // namespace compressup
@@ -0,0 +1,24 @@
+#pragma once
+
+#include "types.h"
+
+#include <array>
+#include <cstddef>
+#include <string_view>
+
+namespace compressup {
+
+// 字节直方图：counts[b] 为字节 b 的出现次数
+using ByteHistogram = std::array<std::size_t, 256>;
+
+// 单线程统计。相邻字节交替累加到 4 张 32 位子表，最后合并：偏斜的输入（如文本）中
+// 同一字节连续出现时，对同一计数器的读改写不必等待上一次写入完成。
+ByteHistogram byte_histogram(std::string_view input);
+
+// 大输入按块分给多个线程统计后合并；输入小于 2 * min_chunk 或只有一个线程时退化为单线程。
+// num_threads 为 0 时使用硬件线程数。
+ByteHistogram byte_histogram_parallel(std::string_view input,
+                                      std::size_t num_threads = 0,
+                                      std::size_t min_chunk = std::size_t{1} << 20);
+
+} // namespace compressup
@@ -1,20 +1,335 @@
 #include "huffman_compressor.h"
 
+#include "bit_stream.h"
+#include "histogram.h"
+#include "huffman_table.h"
+#include "varint.h"
+
 #include <algorithm>
 #include <stdexcept>
 
 namespace compressup {
 
+namespace {
+
+// Canonical 格式的流模式
+constexpr Byte kModeSingleSymbol = 0;  // 只有一种符号：[符号]
+constexpr Byte kModeSingleStream = 1;  // [码长表][比特流]
+constexpr Byte kModeFourStreams = 2;   // [码长表][跳转表][4 个比特流]
+
+// 跳转表：前三个流的字节数，各 4 字节小端序
+constexpr std::size_t kJumpTableSize = 3 * 4;
+
+// 码长表的两种存储方式，取较短者
+constexpr Byte kTableDense = 0;   // [N - 1][符号 0..N-1 的码长，每个 4 位]
+constexpr Byte kTableSparse = 1;  // [K - 1][K 个符号][K 个码长，每个 4 位]
+
+void write_nibbles(std::vector<Byte>& output, const std::vector<std::uint8_t>& values) {
+    for (std::size_t i = 0; i < values.size(); i += 2) {
+        const Byte high = values[i];
+        const Byte low = i + 1 < values.size() ? values[i + 1] : 0;
+        output.push_back(static_cast<Byte>((high << 4) | low));
+    }
+}
+
+std::vector<std::uint8_t> read_nibbles(const Byte*& data, const Byte* end, std::size_t count) {
+    const std::size_t bytes = (count + 1) / 2;
+    if (static_cast<std::size_t>(end - data) < bytes) {
+        throw std::runtime_error("Huffman: truncated code length table");
+    }
+    std::vector<std::uint8_t> values(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        const Byte byte = data[i / 2];
+        values[i] = (i % 2 == 0) ? (byte >> 4) : (byte & 0x0F);
+    }
+    data += bytes;
+    return values;
+}
+
+void write_code_lengths(std::vector<Byte>& output, const std::array<std::uint8_t, 256>& lengths) {
+    std::vector<Byte> symbols;
+    std::vector<std::uint8_t> used_lengths;
+    for (int s = 0; s < 256; ++s) {
+        if (lengths[s] != 0) {
+            symbols.push_back(static_cast<Byte>(s));
+            used_lengths.push_back(lengths[s]);
+        }
+    }
+
+    const std::size_t dense_count = static_cast<std::size_t>(symbols.back()) + 1;
+    const std::size_t dense_size = (dense_count + 1) / 2;
+    const std::size_t sparse_size = symbols.size() + (symbols.size() + 1) / 2;
+
+    if (sparse_size < dense_size) {
+        output.push_back(kTableSparse);
+        output.push_back(static_cast<Byte>(symbols.size() - 1));
+        output.insert(output.end(), symbols.begin(), symbols.end());
+        write_nibbles(output, used_lengths);
+    } else {
+        output.push_back(kTableDense);
+        output.push_back(static_cast<Byte>(dense_count - 1));
+        write_nibbles(output, std::vector<std::uint8_t>(lengths.begin(), lengths.begin() + dense_count));
+    }
+}
+
+std::array<std::uint8_t, 256> read_code_lengths(const Byte*& data, const Byte* end) {
+    if (end - data < 2) {
+        throw std::runtime_error("Huffman: truncated code length table");
+    }
+    const Byte kind = *data++;
+    const std::size_t count = static_cast<std::size_t>(*data++) + 1;
+
+    std::array<std::uint8_t, 256> lengths{};
+    if (kind == kTableDense) {
+        auto values = read_nibbles(data, end, count);
+        std::copy(values.begin(), values.end(), lengths.begin());
+    } else if (kind == kTableSparse) {
+        if (static_cast<std::size_t>(end - data) < count) {
+            throw std::runtime_error("Huffman: truncated code length table");
+        }
+        const Byte* symbols = data;
+        data += count;
+        auto values = read_nibbles(data, end, count);
+        for (std::size_t i = 0; i < count; ++i) {
+            lengths[symbols[i]] = values[i];
+        }
+    } else {
+        throw std::runtime_error("Huffman: invalid code length table");
+    }
+    return lengths;
+}
+
+// 第 k 段（共四段，前三段长度相同）
+std::string_view segment_of(std::string_view input, std::size_t segment, std::size_t k) {
+    const std::size_t begin = std::min(k * segment, input.size());
+    return input.substr(begin, segment);
+}
+
+void encode_symbols(std::vector<Byte>& output, std::string_view input,
+                    const std::array<std::uint64_t, 256>& codes,
+                    const std::array<std::uint8_t, 256>& lengths) {
+    BitWriter writer(output);
+    for (unsigned char c : input) {
+        writer.write(codes[c], lengths[c]);
+    }
+    writer.finish();
+}
+
+// 从 reader 解出 count 个符号：每次补充比特缓冲区后连续解出缓冲区能容纳的最多符号
+void decode_tail(const HuffmanDecodeTable& table, BitReader& reader, char* out, std::size_t count) {
+    const std::size_t per_refill = BitReader::kMinBits / table.max_length();
+    for (std::size_t i = 0; i < count;) {
+        reader.refill();
+        const std::size_t n = std::min(per_refill, count - i);
+        for (std::size_t k = 0; k < n; ++k) {
+            out[i++] = static_cast<char>(table.decode(reader));
+        }
+    }
+}
+
+void decode_symbols(const HuffmanDecodeTable& table, const Byte* data, const Byte* end,
+                    char* out, std::size_t count) {
+    BitReader reader(data, end);
+    decode_tail(table, reader, out, count);
+    if (reader.bits_consumed() > static_cast<std::uint64_t>(end - data) * 8) {
+        throw std::runtime_error("Huffman: truncated bitstream");
+    }
+}
+
+} // namespace
+
+HuffmanCompressor::HuffmanCompressor(HuffmanFormat format)
+    : format_(format) {
+}
+
 std::string HuffmanCompressor::name() const {
     return "huffman";
 }
 
-std::array<std::size_t, 256> HuffmanCompressor::build_frequency_table(std::string_view input) const {
-    std::array<std::size_t, 256> freq{};
-    for (unsigned char c : input) {
-        ++freq[c];
+std::unique_ptr<ICompressor> HuffmanCompressor::clone() const {
+    return std::make_unique<HuffmanCompressor>(*this);
+}
+
+std::uint8_t HuffmanCompressor::format_version() const {
+    return static_cast<std::uint8_t>(format_);
+}
+
+std::vector<Byte> HuffmanCompressor::compress(std::string_view input) {
+    if (input.empty()) {
+        return {};
     }
-    return freq;
+    return format_ == HuffmanFormat::Tree ? compress_tree(input) : compress_canonical(input);
+}
+
+std::string HuffmanCompressor::decompress(const std::vector<Byte>& input) {
+    if (input.empty()) {
+        return {};
+    }
+    return format_ == HuffmanFormat::Tree ? decompress_tree(input) : decompress_canonical(input);
+}
+
+std::vector<Byte> HuffmanCompressor::compress_canonical(std::string_view input) const {
+    auto freq = build_frequency_table(input);
+
+    std::vector<Byte> output;
+    std::size_t distinct = 0;
+    for (std::size_t f : freq) {
+        distinct += f > 0 ? 1 : 0;
+    }
+
+    if (distinct == 1) {
+        output.push_back(kModeSingleSymbol);
+        write_varint(output, input.size());
+        output.push_back(static_cast<Byte>(input[0]));
+        return output;
+    }
+
+    // 码长受限的范式码：只需传输码长，编码时按符号直接查扁平表
+    const auto lengths = build_code_lengths(freq, kMaxCodeLength);
+    const auto codes = canonical_codes(lengths);
+
+    const bool four_streams = input.size() >= kFourStreamThreshold;
+    output.push_back(four_streams ? kModeFourStreams : kModeSingleStream);
+    write_varint(output, input.size());
+    write_code_lengths(output, lengths);
+
+    // 按编码后的总比特数预留输出，比特流直接写入输出缓冲区
+    std::uint64_t bit_count = 0;
+    for (int s = 0; s < 256; ++s) {
+        bit_count += static_cast<std::uint64_t>(freq[s]) * lengths[s];
+    }
+    output.reserve(output.size() + bit_count / 8 + 4 * 8 + kJumpTableSize);
+
+    if (!four_streams) {
+        encode_symbols(output, input, codes, lengths);
+        return output;
+    }
+
+    // 四个段共用一张码表，各自独立成流；跳转表记录前三个流的字节数，写完后回填
+    const std::size_t jump_table = output.size();
+    output.resize(jump_table + kJumpTableSize);
+
+    const std::size_t segment = (input.size() + 3) / 4;
+    for (std::size_t k = 0; k < 4; ++k) {
+        const std::size_t stream_start = output.size();
+        encode_symbols(output, segment_of(input, segment, k), codes, lengths);
+
+        if (k < 3) {
+            const std::uint64_t stream_size = output.size() - stream_start;
+            if (stream_size > UINT32_MAX) {
+                throw std::runtime_error("Huffman: stream too large");
+            }
+            for (int i = 0; i < 4; ++i) {
+                output[jump_table + k * 4 + i] = static_cast<Byte>(stream_size >> (i * 8));
+            }
+        }
+    }
+
+    return output;
+}
+
+std::string HuffmanCompressor::decompress_canonical(const std::vector<Byte>& input) const {
+    const Byte* data = input.data();
+    const Byte* end = data + input.size();
+
+    const Byte mode = *data++;
+    const std::uint64_t orig_len = read_varint(data, end);
+
+    if (mode == kModeSingleSymbol) {
+        if (data >= end) {
+            throw std::runtime_error("Huffman: missing symbol");
+        }
+        return std::string(orig_len, static_cast<char>(*data));
+    }
+    if (mode != kModeSingleStream && mode != kModeFourStreams) {
+        throw std::runtime_error("Huffman: unsupported stream mode");
+    }
+
+    const auto lengths = read_code_lengths(data, end);
+    HuffmanDecodeTable table(canonical_codes(lengths), lengths);
+    if (table.max_length() == 0) {
+        throw std::runtime_error("Huffman: empty code length table");
+    }
+    // 每个符号至少占 1 位：原始长度来自流头，超过剩余载荷位数的流必然损坏，在分配输出之前拒绝
+    if (orig_len / 8 > static_cast<std::uint64_t>(end - data)) {
+        throw std::runtime_error("Huffman: original length exceeds payload");
+    }
+
+    std::string output(orig_len, '\0');
+    char* const out = output.data();
+
+    if (mode == kModeSingleStream) {
+        decode_symbols(table, data, end, out, orig_len);
+        return output;
+    }
+
+    // 读取跳转表，定位四个流
+    if (static_cast<std::size_t>(end - data) < kJumpTableSize) {
+        throw std::runtime_error("Huffman: truncated jump table");
+    }
+    std::array<const Byte*, 5> bounds{};
+    bounds[0] = data + kJumpTableSize;
+    for (std::size_t k = 0; k < 3; ++k) {
+        std::uint32_t stream_size = 0;
+        for (int i = 0; i < 4; ++i) {
+            stream_size |= static_cast<std::uint32_t>(data[k * 4 + i]) << (i * 8);
+        }
+        if (stream_size > static_cast<std::size_t>(end - bounds[k])) {
+            throw std::runtime_error("Huffman: invalid jump table");
+        }
+        bounds[k + 1] = bounds[k] + stream_size;
+    }
+    bounds[4] = end;
+
+    const std::size_t segment = (orig_len + 3) / 4;
+    std::array<std::size_t, 4> segment_size{};
+    for (std::size_t k = 0; k < 4; ++k) {
+        const std::size_t begin = std::min<std::size_t>(k * segment, orig_len);
+        segment_size[k] = std::min<std::size_t>(begin + segment, orig_len) - begin;
+    }
+
+    BitReader r0(bounds[0], bounds[1]);
+    BitReader r1(bounds[1], bounds[2]);
+    BitReader r2(bounds[2], bounds[3]);
+    BitReader r3(bounds[3], bounds[4]);
+    char* const o0 = out;
+    char* const o1 = out + segment_size[0];
+    char* const o2 = o1 + segment_size[1];
+    char* const o3 = o2 + segment_size[2];
+
+    // 四个流交替解码：各流的依赖链相互独立，可以在流水线中重叠执行。
+    // 最后一段最短，先按其长度同步推进，剩余部分再逐流解完
+    const std::size_t per_refill = BitReader::kMinBits / table.max_length();
+    const std::size_t common = segment_size[3];
+    std::size_t i = 0;
+    for (; i + per_refill <= common; i += per_refill) {
+        r0.refill();
+        r1.refill();
+        r2.refill();
+        r3.refill();
+        for (std::size_t k = 0; k < per_refill; ++k) {
+            o0[i + k] = static_cast<char>(table.decode(r0));
+            o1[i + k] = static_cast<char>(table.decode(r1));
+            o2[i + k] = static_cast<char>(table.decode(r2));
+            o3[i + k] = static_cast<char>(table.decode(r3));
+        }
+    }
+
+    std::array<BitReader*, 4> readers = {&r0, &r1, &r2, &r3};
+    std::array<char*, 4> outs = {o0, o1, o2, o3};
+    for (std::size_t k = 0; k < 4; ++k) {
+        decode_tail(table, *readers[k], outs[k] + i, segment_size[k] - i);
+        if (readers[k]->bits_consumed() > static_cast<std::uint64_t>(bounds[k + 1] - bounds[k]) * 8) {
+            throw std::runtime_error("Huffman: truncated bitstream");
+        }
+    }
+
+    return output;
+}
+
+std::array<std::size_t, 256> HuffmanCompressor::build_frequency_table(std::string_view input) const {
+    // 多子表直方图；大输入分块并行统计
+    return byte_histogram_parallel(input);
 }
 
 std::unique_ptr<HuffmanCompressor::Node> HuffmanCompressor::build_tree(
@@ -81,25 +396,27 @@ std::unique_ptr<HuffmanCompressor::Node> HuffmanCompressor::build_tree(
     return nullptr;
 }
 
-void HuffmanCompressor::generate_codes(
-    const Node* node,
-    std::vector<bool>& current_code,
-    std::unordered_map<Byte, std::vector<bool>>& codes) const {
-    
+void HuffmanCompressor::collect_codes(const Node* node,
+                                      std::uint64_t code,
+                                      unsigned length,
+                                      std::array<std::uint64_t, 256>& codes,
+                                      std::array<std::uint8_t, 256>& lengths) const {
     if (!node) return;
     
     if (node->is_leaf()) {
-        codes[node->byte] = current_code.empty() ? std::vector<bool>{false} : current_code;
+        if (length > HuffmanDecodeTable::kMaxCodeLength) {
+            throw std::runtime_error("Huffman: code length exceeds decoder limit");
+        }
+        codes[node->byte] = code;
+        lengths[node->byte] = static_cast<std::uint8_t>(length);
         return;
     }
     
-    current_code.push_back(false);
-    generate_codes(node->left.get(), current_code, codes);
-    current_code.pop_back();
-    
-    current_code.push_back(true);
-    generate_codes(node->right.get(), current_code, codes);
-    current_code.pop_back();
+    if (length >= HuffmanDecodeTable::kMaxCodeLength) {
+        throw std::runtime_error("Huffman: code length exceeds decoder limit");
+    }
+    collect_codes(node->left.get(), code << 1, length + 1, codes, lengths);
+    collect_codes(node->right.get(), (code << 1) | 1, length + 1, codes, lengths);
 }
 
 void HuffmanCompressor::serialize_tree(const Node* node, std::vector<Byte>& output) const {
@@ -149,19 +466,18 @@ std::unique_ptr<HuffmanCompressor::Node> HuffmanCompressor::deserialize_tree(
     return node;
 }
 
-std::vector<Byte> HuffmanCompressor::compress(std::string_view input) {
-    if (input.empty()) {
-        return {};
-    }
-    
+std::vector<Byte> HuffmanCompressor::compress_tree(std::string_view input) const {
     // 构建频率表和Huffman树
     auto freq = build_frequency_table(input);
     auto tree = build_tree(freq);
     
-    // 生成编码表
-    std::unordered_map<Byte, std::vector<bool>> codes;
-    std::vector<bool> current_code;
-    generate_codes(tree.get(), current_code, codes);
+    // 生成扁平编码表
+    std::array<std::uint64_t, 256> codes{};
+    std::array<std::uint8_t, 256> lengths{};
+    if (tree->is_leaf()) {
+        throw std::runtime_error("Huffman: invalid tree");
+    }
+    collect_codes(tree.get(), 0, 0, codes, lengths);
     
     std::vector<Byte> output;
     
@@ -184,38 +500,27 @@ std::vector<Byte> HuffmanCompressor::compress(std::string_view input) {
     // 写入树数据
     output.insert(output.end(), tree_data.begin(), tree_data.end());
     
-    // 编码数据
-    std::vector<bool> bits;
-    for (unsigned char c : input) {
-        const auto& code = codes[c];
-        bits.insert(bits.end(), code.begin(), code.end());
-    }
-    
     // 写入位数据的位数 (用于处理最后一个字节的padding)
-    std::uint64_t bit_count = bits.size();
+    std::uint64_t bit_count = 0;
+    for (int s = 0; s < 256; ++s) {
+        bit_count += static_cast<std::uint64_t>(freq[s]) * lengths[s];
+    }
     for (int i = 0; i < 8; ++i) {
         output.push_back(static_cast<Byte>(bit_count >> (i * 8)));
     }
     
-    // 将bits打包为字节
-    for (std::size_t i = 0; i < bits.size(); i += 8) {
-        Byte byte = 0;
-        for (std::size_t j = 0; j < 8 && i + j < bits.size(); ++j) {
-            if (bits[i + j]) {
-                byte |= (1 << (7 - j));
-            }
-        }
-        output.push_back(byte);
+    // 编码数据
+    output.reserve(output.size() + bit_count / 8 + 8);
+    BitWriter writer(output);
+    for (unsigned char c : input) {
+        writer.write(codes[c], lengths[c]);
     }
+    writer.finish();
     
     return output;
 }
 
-std::string HuffmanCompressor::decompress(const std::vector<Byte>& input) {
-    if (input.empty()) {
-        return {};
-    }
-    
+std::string HuffmanCompressor::decompress_tree(const std::vector<Byte>& input) const {
     if (input.size() < 20) {
         throw std::runtime_error("Huffman: input too short");
     }
@@ -250,36 +555,35 @@ std::string HuffmanCompressor::decompress(const std::vector<Byte>& input) {
         bit_count |= static_cast<std::uint64_t>(*data++) << (i * 8);
     }
     
-    // 解码
-    std::string output;
-    output.reserve(orig_len);
+    if (!tree || tree->is_leaf()) {
+        throw std::runtime_error("Huffman: invalid tree data");
+    }
     
-    const Node* current = tree.get();
-    std::uint64_t bits_read = 0;
+    // 每个符号至少占 1 位：比特数不能超过载荷，原始长度不能超过比特数，否则在分配输出之前拒绝
+    if (bit_count / 8 > static_cast<std::uint64_t>(end - data) || orig_len > bit_count) {
+        throw std::runtime_error("Huffman: original length exceeds payload");
+    }
     
-    while (data < end && output.size() < orig_len) {
-        Byte byte = *data++;
-        for (int i = 7; i >= 0 && bits_read < bit_count && output.size() < orig_len; --i, ++bits_read) {
-            bool bit = (byte >> i) & 1;
-            
-            if (bit) {
-                current = current->right.get();
-            } else {
-                current = current->left.get();
-            }
-            
-            if (!current) {
-                throw std::runtime_error("Huffman: invalid encoded data");
-            }
-            
-            if (current->is_leaf()) {
-                output.push_back(static_cast<char>(current->byte));
-                current = tree.get();
-            }
+    // 由树得到每个符号的码字，构建查表解码器
+    std::array<std::uint64_t, 256> codes{};
+    std::array<std::uint8_t, 256> lengths{};
+    collect_codes(tree.get(), 0, 0, codes, lengths);
+    HuffmanDecodeTable table(codes, lengths);
+    
+    // 解码：每次补充比特缓冲区后连续解出缓冲区能容纳的最多符号
+    std::string output(orig_len, '\0');
+    BitReader reader(data, end);
+    const std::size_t per_refill = std::max<std::size_t>(1, BitReader::kMinBits / table.max_length());
+    
+    for (std::size_t i = 0; i < orig_len;) {
+        reader.refill();
+        const std::size_t count = std::min<std::size_t>(per_refill, orig_len - i);
+        for (std::size_t k = 0; k < count; ++k) {
+            output[i++] = static_cast<char>(table.decode(reader));
         }
     }
     
-    if (output.size() != orig_len) {
+    if (reader.bits_consumed() > bit_count) {
         throw std::runtime_error("Huffman: output size mismatch");
     }
     
@@ -3,19 +3,42 @@
 #include "compressor.h"
 
 #include <array>
+#include <cstdint>
 #include <memory>
 #include <queue>
-#include <unordered_map>
 
 namespace compressup {
 
+// Huffman 流格式版本
+enum class HuffmanFormat : std::uint8_t {
+    Tree = 1,       // 前序序列化整棵树 + 8 字节比特数
+    Canonical = 2,  // 码长受限的范式码，只传输码长表
+};
+
 class HuffmanCompressor : public ICompressor {
 public:
+    explicit HuffmanCompressor(HuffmanFormat format = HuffmanFormat::Canonical);
+
     std::string name() const override;
+    std::unique_ptr<ICompressor> clone() const override;
     std::vector<Byte> compress(std::string_view input) override;
     std::string decompress(const std::vector<Byte>& input) override;
+    std::uint8_t format_version() const override;
+
+    // Canonical 格式的最大码长：码长表每项 4 位，解码一次查表即可解出任意符号
+    static constexpr unsigned kMaxCodeLength = 11;
+
+    // 不小于该长度的输入分成四段，各段独立成流，解码时四个流交替推进
+    static constexpr std::size_t kFourStreamThreshold = 4096;
 
 private:
+    std::vector<Byte> compress_tree(std::string_view input) const;
+    std::vector<Byte> compress_canonical(std::string_view input) const;
+    std::string decompress_tree(const std::vector<Byte>& input) const;
+    std::string decompress_canonical(const std::vector<Byte>& input) const;
+
+    HuffmanFormat format_;
+
     // Huffman树节点
     struct Node {
         Byte byte{0};
@@ -32,10 +55,12 @@ private:
     // 构建Huffman树
     std::unique_ptr<Node> build_tree(const std::array<std::size_t, 256>& freq) const;
     
-    // 生成编码表
-    void generate_codes(const Node* node, 
-                       std::vector<bool>& current_code,
-                       std::unordered_map<Byte, std::vector<bool>>& codes) const;
+    // 由树收集每个符号的码字（高位先发送）与码长，供编码与查表解码使用
+    void collect_codes(const Node* node,
+                       std::uint64_t code,
+                       unsigned length,
+                       std::array<std::uint64_t, 256>& codes,
+                       std::array<std::uint8_t, 256>& lengths) const;
     
     // 序列化树结构
     void serialize_tree(const Node* node, std::vector<Byte>& output) const;
@@ -0,0 +1,176 @@
+#include "huffman_table.h"
+
+#include <algorithm>
+#include <iterator>
+#include <map>
+
+namespace compressup {
+
+std::array<std::uint8_t, 256> build_code_lengths(const std::array<std::size_t, 256>& freq,
+                                                 unsigned max_length) {
+    std::array<std::uint8_t, 256> lengths{};
+
+    std::vector<int> symbols;
+    for (int s = 0; s < 256; ++s) {
+        if (freq[s] > 0) {
+            symbols.push_back(s);
+        }
+    }
+    if (symbols.empty()) {
+        return lengths;
+    }
+    if (symbols.size() == 1) {
+        lengths[symbols[0]] = 1;
+        return lengths;
+    }
+    if (max_length >= 64 || (std::size_t{1} << max_length) < symbols.size()) {
+        throw std::invalid_argument("Huffman: code length limit too small");
+    }
+
+    std::stable_sort(symbols.begin(), symbols.end(),
+                     [&](int a, int b) { return freq[a] < freq[b]; });
+
+    // 每个元素是一个叶子或由上一层两个元素打包而成的包
+    struct Item {
+        std::uint64_t weight;
+        int symbol;  // 叶子的符号，包为 -1
+        int left;
+        int right;
+    };
+    std::vector<Item> items;
+    std::vector<int> leaves;
+    for (int s : symbols) {
+        leaves.push_back(static_cast<int>(items.size()));
+        items.push_back({freq[s], s, -1, -1});
+    }
+
+    // 第 1 层只有叶子；之后每层把上一层两两打包，再与叶子按权重归并
+    std::vector<int> list = leaves;
+    std::vector<int> packages;
+    std::vector<int> merged;
+    for (unsigned level = 1; level < max_length; ++level) {
+        packages.clear();
+        for (std::size_t i = 0; i + 1 < list.size(); i += 2) {
+            packages.push_back(static_cast<int>(items.size()));
+            items.push_back({items[list[i]].weight + items[list[i + 1]].weight, -1, list[i], list[i + 1]});
+        }
+
+        merged.clear();
+        std::merge(leaves.begin(), leaves.end(), packages.begin(), packages.end(),
+                   std::back_inserter(merged),
+                   [&](int a, int b) { return items[a].weight < items[b].weight; });
+        list.swap(merged);
+    }
+
+    // 取最轻的 2n - 2 个元素，每个叶子在其中出现的次数即为码长
+    std::vector<int> stack(list.begin(), list.begin() + static_cast<std::ptrdiff_t>(2 * symbols.size() - 2));
+    while (!stack.empty()) {
+        const Item& item = items[stack.back()];
+        stack.pop_back();
+        if (item.symbol >= 0) {
+            ++lengths[item.symbol];
+        } else {
+            stack.push_back(item.left);
+            stack.push_back(item.right);
+        }
+    }
+
+    return lengths;
+}
+
+std::array<std::uint64_t, 256> canonical_codes(const std::array<std::uint8_t, 256>& lengths) {
+    std::array<std::uint64_t, 256> codes{};
+
+    std::array<std::uint32_t, 65> count{};
+    for (std::uint8_t len : lengths) {
+        if (len > 64) {
+            throw std::invalid_argument("Huffman: code length too large");
+        }
+        ++count[len];
+    }
+    count[0] = 0;
+
+    // 每个码长的第一个码字
+    std::array<std::uint64_t, 65> next{};
+    std::uint64_t code = 0;
+    for (unsigned len = 1; len <= 64; ++len) {
+        code = (code + count[len - 1]) << 1;
+        next[len] = code;
+    }
+
+    for (int s = 0; s < 256; ++s) {
+        if (lengths[s] != 0) {
+            codes[s] = next[lengths[s]]++;
+        }
+    }
+    return codes;
+}
+
+HuffmanDecodeTable::HuffmanDecodeTable(const std::array<std::uint64_t, 256>& codes,
+                                       const std::array<std::uint8_t, 256>& lengths) {
+    std::vector<int> symbols;
+    for (int s = 0; s < 256; ++s) {
+        if (lengths[s] == 0) {
+            continue;
+        }
+        if (lengths[s] > kMaxCodeLength) {
+            throw std::runtime_error("Huffman: code length exceeds decoder limit");
+        }
+        symbols.push_back(s);
+        max_length_ = std::max<unsigned>(max_length_, lengths[s]);
+    }
+
+    entries_.resize(std::size_t{1} << kPrimaryBits);
+    fill(0, kPrimaryBits, 0, symbols, codes, lengths);
+}
+
+void HuffmanDecodeTable::fill(std::size_t base, unsigned table_bits, unsigned depth,
+                              const std::vector<int>& symbols,
+                              const std::array<std::uint64_t, 256>& codes,
+                              const std::array<std::uint8_t, 256>& lengths) {
+    // 码长超出本表的符号按本表索引分组，每组一张子表
+    std::map<std::uint32_t, std::vector<int>> long_codes;
+
+    for (int s : symbols) {
+        const unsigned rest = lengths[s] - depth;  // 本表及之后需要解析的位数
+        const std::uint64_t code = codes[s];
+
+        if (rest <= table_bits) {
+            // 短码字占据以其为前缀的所有表项
+            const std::size_t first = static_cast<std::size_t>(code & ((std::uint64_t{1} << rest) - 1))
+                                      << (table_bits - rest);
+            const std::size_t count = std::size_t{1} << (table_bits - rest);
+            for (std::size_t i = 0; i < count; ++i) {
+                Entry& entry = entries_[base + first + i];
+                if (entry.kind != kInvalid) {
+                    throw std::runtime_error("Huffman: codes are not prefix-free");
+                }
+                entry = {static_cast<std::uint32_t>(s), static_cast<std::uint8_t>(rest), kSymbol};
+            }
+        } else {
+            const auto index = static_cast<std::uint32_t>(
+                (code >> (rest - table_bits)) & ((std::uint64_t{1} << table_bits) - 1));
+            long_codes[index].push_back(s);
+        }
+    }
+
+    for (const auto& [index, group] : long_codes) {
+        unsigned max_rest = 0;
+        for (int s : group) {
+            max_rest = std::max(max_rest, lengths[s] - depth - table_bits);
+        }
+        const unsigned sub_bits = std::min(max_rest, kPrimaryBits);
+        const std::size_t sub_base = entries_.size();
+
+        if (entries_[base + index].kind != kInvalid) {
+            throw std::runtime_error("Huffman: codes are not prefix-free");
+        }
+        entries_.resize(sub_base + (std::size_t{1} << sub_bits));
+        entries_[base + index] = {static_cast<std::uint32_t>(sub_base),
+                                  static_cast<std::uint8_t>(sub_bits), kLink};
+
+        fill(sub_base, sub_bits, depth + table_bits, group, codes, lengths);
+    }
+}
+
+} // namespace compressup
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "bit_stream.h"
+#include "types.h"
+
+#include <array>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+namespace compressup {
+
+// 由符号频率计算最优前缀码的码长，码长不超过 max_length（package-merge 算法）。
+// 未出现的符号码长为 0；只有一个符号出现时其码长为 1。
+std::array<std::uint8_t, 256> build_code_lengths(const std::array<std::size_t, 256>& freq,
+                                                 unsigned max_length);
+
+// 按（码长，符号）的顺序为各符号分配范式码，码长为 0 的符号不分配
+std::array<std::uint64_t, 256> canonical_codes(const std::array<std::uint8_t, 256>& lengths);
+
+// Huffman 查表解码器
+// 一级表以接下来的 kPrimaryBits 个比特为索引，码长不超过该值的符号一次查表即可解出；
+// 更长的码字由一级表项链接到二级表（必要时继续链接），每级最多再解析 kPrimaryBits 位。
+class HuffmanDecodeTable {
+public:
+    static constexpr unsigned kPrimaryBits = 11;
+    // 单个码字必须能在一次补充后的比特缓冲区内解完
+    static constexpr unsigned kMaxCodeLength = BitReader::kMinBits;
+
+    // codes[s] 为符号 s 的码字（高位先发送），lengths[s] 为码长，0 表示符号未出现
+    HuffmanDecodeTable(const std::array<std::uint64_t, 256>& codes,
+                       const std::array<std::uint8_t, 256>& lengths);
+
+    // 最长码字的长度，调用方据此决定每次补充缓冲区后可以连续解码的符号数
+    unsigned max_length() const { return max_length_; }
+
+    // 解码一个符号；调用方需保证缓冲区中至少有 max_length() 个比特
+    Byte decode(BitReader& reader) const {
+        Entry entry = entries_[reader.peek(kPrimaryBits)];
+        unsigned table_bits = kPrimaryBits;
+        while (entry.kind == kLink) {
+            reader.consume(table_bits);
+            table_bits = entry.bits;
+            entry = entries_[entry.value + reader.peek(table_bits)];
+        }
+        if (entry.kind != kSymbol) {
+            throw std::runtime_error("Huffman: invalid encoded data");
+        }
+        reader.consume(entry.bits);
+        return static_cast<Byte>(entry.value);
+    }
+
+private:
+    enum Kind : std::uint8_t {
+        kInvalid = 0,
+        kSymbol = 1,
+        kLink = 2,
+    };
+
+    struct Entry {
+        std::uint32_t value{0};  // 符号，或子表在 entries_ 中的起始位置
+        std::uint8_t bits{0};    // 符号项：本级消耗的位数；链接项：子表的索引位数
+        Kind kind{kInvalid};
+    };
+
+    // 填充起始于 base、索引位数为 table_bits 的表，symbols 为码字前 depth 位已匹配的符号
+    void fill(std::size_t base, unsigned table_bits, unsigned depth,
+              const std::vector<int>& symbols,
+              const std::array<std::uint64_t, 256>& codes,
+              const std::array<std::uint8_t, 256>& lengths);
+
+    std::vector<Entry> entries_;
+    unsigned max_length_ = 0;
+};
+
+} // namespace compressup
@@ -1,14 +1,267 @@
 #include "lz77_compressor.h"
 
+#include "lz_copy.h"
+#include "match_finder.h"
+#include "match_length.h"
+#include "varint.h"
+
+#include <algorithm>
+#include <cstring>
 #include <stdexcept>
 
 namespace compressup {
 
+namespace {
+
+// Wide 格式的序列 token：高 4 位为字面量个数，低 4 位为 匹配长度 - kWideMinMatch，
+// 取 15 时在后面追加 varint 扩展值
+constexpr std::size_t kNibbleMax = 15;
+
+// Wide 流解码时输出的初始分配：原始长度来自流头、不可信（varint 匹配长度使压缩率没有上限，
+// 无法由输入大小判断原始长度是否可能），先按输入大小的若干倍分配，写不下时倍增
+constexpr std::size_t kInitialExpansion = 8;
+constexpr std::size_t kMinInitialOutput = 64 * 1024;
+
+void write_wide_sequence(std::vector<Byte>& out, std::string_view literals,
+                         std::size_t match_length, std::size_t offset) {
+    const std::size_t lit_code = std::min(literals.size(), kNibbleMax);
+    const std::size_t len_code = match_length > 0
+        ? std::min(match_length - Lz77Compressor::kWideMinMatch, kNibbleMax)
+        : 0;
+
+    out.push_back(static_cast<Byte>((lit_code << 4) | len_code));
+    if (lit_code == kNibbleMax) {
+        write_varint(out, literals.size() - kNibbleMax);
+    }
+    out.insert(out.end(), literals.begin(), literals.end());
+
+    // 流末尾的纯字面量序列没有匹配部分
+    if (match_length == 0) {
+        return;
+    }
+
+    write_varint(out, offset);
+    if (len_code == kNibbleMax) {
+        write_varint(out, match_length - Lz77Compressor::kWideMinMatch - kNibbleMax);
+    }
+}
+
+} // namespace
+
+Lz77Compressor::Lz77Compressor(const Lz77Options& options)
+    : options_(options) {
+
+    if (options_.format == Lz77Format::Wide) {
+        const std::size_t w = options_.window_size;
+        if (w < kMinWideWindow || w > kMaxWideWindow || (w & (w - 1)) != 0) {
+            throw std::invalid_argument("LZ77: window size must be a power of two in [1 KB, 1 MB]");
+        }
+        options_.max_chain_depth = std::clamp<std::size_t>(options_.max_chain_depth, 1, w);
+        options_.nice_length = std::max(options_.nice_length, kWideMinMatch);
+    } else {
+        options_.window_size = kWindowSize;
+        options_.max_chain_depth = std::clamp<std::size_t>(options_.max_chain_depth, 1, kMaxChainDepth);
+    }
+}
+
+Lz77Compressor::Lz77Compressor(CompressionLevel level)
+    : Lz77Compressor(options_for_level(level)) {}
+
+Lz77Options Lz77Compressor::options_for_level(CompressionLevel level) {
+    Lz77Options options;
+    switch (level) {
+    case CompressionLevel::Fastest:
+        options.window_size = std::size_t{1} << 14;
+        options.max_chain_depth = 4;
+        options.nice_length = 16;
+        break;
+    case CompressionLevel::Fast:
+        options.window_size = std::size_t{1} << 15;
+        options.max_chain_depth = 16;
+        options.nice_length = 32;
+        break;
+    case CompressionLevel::Default:
+        break;
+    case CompressionLevel::Better:
+        options.window_size = std::size_t{1} << 18;
+        options.max_chain_depth = 256;
+        options.nice_length = 258;
+        options.lazy = true;
+        break;
+    case CompressionLevel::Best:
+    default:
+        options.window_size = kMaxWideWindow;
+        options.max_chain_depth = 1024;
+        options.nice_length = 1024;
+        options.lazy = true;
+        break;
+    }
+    return options;
+}
+
 std::string Lz77Compressor::name() const {
     return "lz77";
 }
 
+std::unique_ptr<ICompressor> Lz77Compressor::clone() const {
+    return std::make_unique<Lz77Compressor>(*this);
+}
+
+std::uint8_t Lz77Compressor::format_version() const {
+    return static_cast<std::uint8_t>(options_.format);
+}
+
 std::vector<Byte> Lz77Compressor::compress(std::string_view input) {
+    if (options_.format == Lz77Format::Legacy) {
+        return compress_legacy(input);
+    }
+    return compress_wide(input);
+}
+
+std::string Lz77Compressor::decompress(const std::vector<Byte>& input) {
+    // Legacy 流的首个 token 必然是字面量 (0x80)，Wide 流以格式版本字节开头
+    if (!input.empty() && input[0] == static_cast<Byte>(Lz77Format::Wide)) {
+        return decompress_wide(input);
+    }
+    return decompress_legacy(input);
+}
+
+std::vector<Byte> Lz77Compressor::compress_wide(std::string_view input) const {
+    std::vector<Byte> out;
+    const std::size_t n = input.size();
+    if (n == 0) {
+        return out;
+    }
+
+    out.reserve(n / 2 + 16);
+    out.push_back(static_cast<Byte>(Lz77Format::Wide));
+    write_varint(out, n);
+
+    HashChainMatchFinder finder(options_.window_size, options_.max_chain_depth);
+    finder.reset(input);
+
+    std::size_t pos = 0;
+    std::size_t literal_start = 0;
+    while (pos < n) {
+        Match match = finder.find(pos, n - pos, options_.nice_length);
+        finder.insert(pos);
+
+        if (match.length < kWideMinMatch) {
+            ++pos;
+            continue;
+        }
+
+        // 惰性匹配：下一位置的匹配更长时，把当前字节留作字面量
+        while (options_.lazy && match.length < options_.nice_length && pos + 1 < n) {
+            Match next = finder.find(pos + 1, n - pos - 1, options_.nice_length);
+            if (next.length <= match.length) {
+                break;
+            }
+            ++pos;
+            finder.insert(pos);
+            match = next;
+        }
+
+        write_wide_sequence(out, input.substr(literal_start, pos - literal_start),
+                            match.length, match.offset);
+
+        for (std::size_t i = 1; i < match.length; ++i) {
+            finder.insert(pos + i);
+        }
+        pos += match.length;
+        literal_start = pos;
+    }
+
+    if (literal_start < n) {
+        write_wide_sequence(out, input.substr(literal_start), 0, 0);
+    }
+
+    return out;
+}
+
+std::string Lz77Compressor::decompress_wide(const std::vector<Byte>& input) const {
+    const Byte* data = input.data() + 1;
+    const Byte* end = input.data() + input.size();
+
+    const std::uint64_t orig_len = read_varint(data, end);
+
+    // 直接写入输出；分配不超过原始长度，损坏的流不会因声称的长度一次申请巨大的内存
+    const std::uint64_t initial_size =
+        std::max<std::uint64_t>(kMinInitialOutput, static_cast<std::uint64_t>(input.size()) * kInitialExpansion);
+    std::string output(static_cast<std::size_t>(std::min(orig_len, initial_size)), '\0');
+    Byte* out_begin = reinterpret_cast<Byte*>(output.data());
+    Byte* out_end = out_begin + output.size();
+    Byte* op = out_begin;
+
+    // 保证 op 之后还有 count 字节可写（调用方已确认不超过原始长度）
+    auto reserve_output = [&](std::uint64_t count) {
+        if (count <= static_cast<std::uint64_t>(out_end - op)) {
+            return;
+        }
+        const auto written = static_cast<std::size_t>(op - out_begin);
+        const std::uint64_t grown =
+            std::max<std::uint64_t>(written + count, 2 * static_cast<std::uint64_t>(output.size()));
+        output.resize(static_cast<std::size_t>(std::min(orig_len, grown)));
+        out_begin = reinterpret_cast<Byte*>(output.data());
+        out_end = out_begin + output.size();
+        op = out_begin + written;
+    };
+
+    for (std::uint64_t remaining = orig_len; remaining > 0;) {
+        if (data >= end) {
+            throw std::runtime_error("LZ77: unexpected end of wide stream");
+        }
+        const Byte token = *data++;
+
+        std::uint64_t literal_count = token >> 4;
+        if (literal_count == kNibbleMax) {
+            literal_count += read_varint(data, end);
+        }
+        if (literal_count > static_cast<std::uint64_t>(end - data) || literal_count > remaining) {
+            throw std::runtime_error("LZ77: invalid literal run");
+        }
+        reserve_output(literal_count);
+
+        // 短字面量游程在两侧都有余量时整块复制 16 字节
+        if (literal_count <= 16 && end - data >= 16 && out_end - op >= 16) {
+            std::memcpy(op, data, 16);
+        } else {
+            std::memcpy(op, data, literal_count);
+        }
+        op += literal_count;
+        data += literal_count;
+        remaining -= literal_count;
+
+        if (remaining == 0) {
+            break;
+        }
+
+        const std::uint64_t offset = read_varint(data, end);
+        std::uint64_t length = (token & 0x0F) + kWideMinMatch;
+        if ((token & 0x0F) == kNibbleMax) {
+            length += read_varint(data, end);
+        }
+        if (offset == 0 || offset > static_cast<std::uint64_t>(op - out_begin)) {
+            throw std::runtime_error("Invalid LZ77 match offset");
+        }
+        if (length > remaining) {
+            throw std::runtime_error("Invalid LZ77 match length");
+        }
+        reserve_output(length);
+
+        if (length + kWildCopyOverrun <= static_cast<std::uint64_t>(out_end - op)) {
+            copy_match(op, offset, length);
+        } else {
+            copy_match_exact(op, offset, length);
+        }
+        op += length;
+        remaining -= length;
+    }
+
+    return output;
+}
+
+std::vector<Byte> Lz77Compressor::compress_legacy(std::string_view input) const {
     std::vector<Byte> out;
     const std::size_t n = input.size();
     if (n == 0) {
@@ -17,29 +270,30 @@ std::vector<Byte> Lz77Compressor::compress(std::string_view input) {
 
     out.reserve(n);
 
+    HashChainMatchFinder finder(kWindowSize, options_.max_chain_depth);
+    finder.reset(input);
+
+    // 搜索整个窗口时不能提前结束：穷举搜索在等长匹配中保留最远的候选
+    const bool exhaustive = options_.max_chain_depth >= kMaxChainDepth;
+
     std::size_t pos = 0;
     while (pos < n) {
         std::size_t bestLen = 0;
         std::size_t bestOffset = 0;
 
-        const std::size_t windowStart = (pos > kWindowSize) ? (pos - kWindowSize) : 0;
+        const std::size_t maxLen = std::min(kMaxMatchLength, n - pos);
 
-        for (std::size_t candidate = windowStart; candidate < pos; ++candidate) {
-            std::size_t length = 0;
-            while (length < kMaxMatchLength &&
-                   pos + length < n &&
-                   input[candidate + length] == input[pos + length]) {
-                ++length;
-            }
+        // 候选按由近到远访问，用 >= 使等长时较远的候选胜出
+        const Byte* data = reinterpret_cast<const Byte*>(input.data());
+        finder.for_each_candidate(pos, [&](std::size_t candidate) {
+            std::size_t length = match_length(data + candidate, data + pos, maxLen);
 
-            if (length > bestLen && length >= 3) {
+            if (length >= bestLen && length >= 3) {
                 bestLen = length;
                 bestOffset = pos - candidate;
-                if (bestLen == kMaxMatchLength) {
-                    break;
-                }
             }
-        }
+            return exhaustive || bestLen < kMaxMatchLength;
+        });
 
         if (bestLen >= 3 && bestOffset > 0 && bestOffset <= 0xFFFF) {
             Byte lengthByte = static_cast<Byte>(bestLen); // high bit 0 => match token
@@ -50,12 +304,16 @@ std::vector<Byte> Lz77Compressor::compress(std::string_view input) {
             out.push_back(offsetHigh);
             out.push_back(offsetLow);
 
+            for (std::size_t i = 0; i < bestLen; ++i) {
+                finder.insert(pos + i);
+            }
             pos += bestLen;
         } else {
             Byte flag = static_cast<Byte>(0x80); // literal token
             Byte ch = static_cast<Byte>(static_cast<unsigned char>(input[pos]));
             out.push_back(flag);
             out.push_back(ch);
+            finder.insert(pos);
             ++pos;
         }
     }
@@ -63,27 +321,20 @@ std::vector<Byte> Lz77Compressor::compress(std::string_view input) {
     return out;
 }
 
-std::string Lz77Compressor::decompress(const std::vector<Byte>& input) {
-    std::string output;
-    output.reserve(input.size());
-
-    std::size_t pos = 0;
+std::string Lz77Compressor::decompress_legacy(const std::vector<Byte>& input) const {
     const std::size_t n = input.size();
 
-    while (pos < n) {
-        if (pos >= n) {
-            throw std::runtime_error("Unexpected end of input in LZ77 stream");
-        }
-
+    // Legacy 流不记录原始长度：先扫描一遍 token 求出输出大小，同时校验 token 结构
+    std::size_t output_size = 0;
+    for (std::size_t pos = 0; pos < n;) {
         Byte token = input[pos++];
 
         if (token & 0x80u) {
-            // literal
             if (pos >= n) {
                 throw std::runtime_error("LZ77 literal token missing byte");
             }
-            Byte ch = input[pos++];
-            output.push_back(static_cast<char>(ch));
+            output_size += 1;
+            pos += 1;
         } else {
             // match: token = length (3..kMaxMatchLength)
             std::size_t length = static_cast<std::size_t>(token);
@@ -93,18 +344,35 @@ std::string Lz77Compressor::decompress(const std::vector<Byte>& input) {
             if (pos + 1 >= n) {
                 throw std::runtime_error("LZ77 match token missing offset bytes");
             }
-            std::size_t offsetHigh = static_cast<std::size_t>(input[pos++]);
-            std::size_t offsetLow = static_cast<std::size_t>(input[pos++]);
-            std::size_t offset = (offsetHigh << 8) | offsetLow;
-            if (offset == 0 || offset > output.size()) {
+            output_size += length;
+            pos += 2;
+        }
+    }
+
+    std::string output(output_size, '\0');
+    Byte* const out_begin = reinterpret_cast<Byte*>(output.data());
+    Byte* const out_end = out_begin + output_size;
+    Byte* op = out_begin;
+
+    for (std::size_t pos = 0; pos < n;) {
+        Byte token = input[pos++];
+
+        if (token & 0x80u) {
+            *op++ = input[pos++];
+        } else {
+            std::size_t length = static_cast<std::size_t>(token);
+            std::size_t offset = (static_cast<std::size_t>(input[pos]) << 8) | input[pos + 1];
+            pos += 2;
+            if (offset == 0 || offset > static_cast<std::size_t>(op - out_begin)) {
                 throw std::runtime_error("Invalid LZ77 match offset");
             }
 
-            std::size_t start = output.size() - offset;
-            for (std::size_t i = 0; i < length; ++i) {
-                char c = output[start + i];
-                output.push_back(c);
+            if (static_cast<std::size_t>(out_end - op) >= length + kWildCopyOverrun) {
+                copy_match(op, offset, length);
+            } else {
+                copy_match_exact(op, offset, length);
             }
+            op += length;
         }
     }
 
@@ -2,16 +2,59 @@
 
 #include "compressor.h"
 
+#include <cstdint>
+
 namespace compressup {
 
+// LZ77 流格式版本
+enum class Lz77Format : std::uint8_t {
+    Legacy = 1,  // 固定 token：字面量 2 字节，匹配 3 字节，窗口 1 KB
+    Wide = 2,    // 字面量游程 + 变长匹配长度/偏移，窗口最大 1 MB
+};
+
+// LZ77 参数
+struct Lz77Options {
+    Lz77Format format = Lz77Format::Wide;
+    std::size_t window_size = std::size_t{1} << 16;  // 仅 Wide 格式使用，2 的幂
+    std::size_t max_chain_depth = 64;                // 每个位置最多检查的哈希链候选数
+    std::size_t nice_length = 128;                   // 找到该长度的匹配即停止搜索（Wide 格式）
+    bool lazy = false;                               // 惰性匹配：下一位置匹配更长时推迟输出（Wide 格式）
+};
+
 class Lz77Compressor : public ICompressor {
 public:
+    // Legacy 格式下 max_chain_depth 取 kMaxChainDepth 时搜索整个窗口，
+    // 输出与穷举搜索逐字节一致
+    explicit Lz77Compressor(const Lz77Options& options = {});
+
+    // 按压缩级别选择窗口、链深度与解析策略（Wide 格式）
+    explicit Lz77Compressor(CompressionLevel level);
+
+    static Lz77Options options_for_level(CompressionLevel level);
+
     std::string name() const override;
+    std::unique_ptr<ICompressor> clone() const override;
     std::vector<Byte> compress(std::string_view input) override;
     std::string decompress(const std::vector<Byte>& input) override;
+    std::uint8_t format_version() const override;
 
+    // Legacy 格式参数
     static constexpr std::size_t kWindowSize = 1024;
     static constexpr std::size_t kMaxMatchLength = 32;
+    static constexpr std::size_t kMaxChainDepth = kWindowSize;
+
+    // Wide 格式参数
+    static constexpr std::size_t kWideMinMatch = 4;
+    static constexpr std::size_t kMinWideWindow = std::size_t{1} << 10;
+    static constexpr std::size_t kMaxWideWindow = std::size_t{1} << 20;
+
+private:
+    std::vector<Byte> compress_legacy(std::string_view input) const;
+    std::vector<Byte> compress_wide(std::string_view input) const;
+    std::string decompress_legacy(const std::vector<Byte>& input) const;
+    std::string decompress_wide(const std::vector<Byte>& input) const;
+
+    Lz77Options options_;
 };
 
 } // namespace compressup
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "types.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace compressup {
+
+// LZ 解码器的快速复制原语。快速路径按 8/16 字节整块复制，可能越过目标末尾多写
+// 至多 kWildCopyOverrun - 1 个字节，调用方需保证输出缓冲区在该处仍有这么多空间，
+// 靠近缓冲区末尾时改走逐字节的检查路径。
+constexpr std::size_t kWildCopyOverrun = 16;
+
+// 每次复制 16 字节；要求目标与源不重叠或相距至少 16 字节
+inline void wild_copy16(Byte* dst, const Byte* src, std::size_t length) {
+    Byte* const end = dst + length;
+    while (dst < end) {
+        std::memcpy(dst, src, 16);
+        dst += 16;
+        src += 16;
+    }
+}
+
+// 每次复制 8 字节；要求目标与源相距至少 8 字节
+inline void wild_copy8(Byte* dst, const Byte* src, std::size_t length) {
+    Byte* const end = dst + length;
+    while (dst < end) {
+        std::memcpy(dst, src, 8);
+        dst += 8;
+        src += 8;
+    }
+}
+
+// 从 op - offset 复制 length 字节到 op，正确处理 offset < length 的重叠匹配
+inline void copy_match(Byte* op, std::size_t offset, std::size_t length) {
+    const Byte* src = op - offset;
+
+    if (offset >= 16) {
+        wild_copy16(op, src, length);
+        return;
+    }
+    if (offset >= 8) {
+        wild_copy8(op, src, length);
+        return;
+    }
+
+    // 周期小于 8：输出以 offset 为周期，先逐字节写出开头几个字节，
+    // 之后即可从 step（offset 的倍数且不小于 8）之前整块复制
+    std::size_t step = offset;
+    while (step < 8) {
+        step += offset;
+    }
+
+    const std::size_t head = std::min(length, step - offset);
+    for (std::size_t i = 0; i < head; ++i) {
+        op[i] = src[i];
+    }
+    if (head == length) {
+        return;
+    }
+
+    op += head;
+    wild_copy8(op, op - step, length - head);
+}
+
+// 逐字节复制，用于缓冲区末尾附近，不会越界写
+inline void copy_match_exact(Byte* op, std::size_t offset, std::size_t length) {
+    const Byte* src = op - offset;
+    for (std::size_t i = 0; i < length; ++i) {
+        op[i] = src[i];
+    }
+}
+
+} // namespace compressup
@@ -0,0 +1,164 @@
+#include "lzh_compressor.h"
+
+#include "huffman_compressor.h"
+#include "lz_copy.h"
+#include "varint.h"
+
+#include <array>
+#include <stdexcept>
+
+namespace compressup {
+
+namespace {
+
+// 流的顺序：命令、字面量、偏移高字节、偏移低字节
+constexpr std::size_t kStreamCount = 4;
+
+void write_stream(std::vector<Byte>& output, const std::vector<Byte>& stream) {
+    HuffmanCompressor huffman(HuffmanFormat::Canonical);
+    std::vector<Byte> encoded =
+        huffman.compress(std::string_view(reinterpret_cast<const char*>(stream.data()), stream.size()));
+    write_varint(output, encoded.size());
+    output.insert(output.end(), encoded.begin(), encoded.end());
+}
+
+std::string read_stream(const Byte*& data, const Byte* end, HuffmanFormat format) {
+    const std::uint64_t size = read_varint(data, end);
+    if (size > static_cast<std::uint64_t>(end - data)) {
+        throw std::runtime_error("LZH: truncated stream");
+    }
+
+    HuffmanCompressor huffman(format);
+    std::string decoded = huffman.decompress(std::vector<Byte>(data, data + size));
+    data += size;
+    return decoded;
+}
+
+} // namespace
+
+LzhCompressor::LzhCompressor(CompressionLevel level)
+    : parser_(level) {
+}
+
+std::string LzhCompressor::name() const {
+    return "lzh";
+}
+
+std::unique_ptr<ICompressor> LzhCompressor::clone() const {
+    return std::make_unique<LzhCompressor>(*this);
+}
+
+std::vector<Byte> LzhCompressor::compress(std::string_view input) {
+    if (input.empty()) {
+        return {};
+    }
+
+    std::vector<Byte> commands;
+    std::vector<Byte> literals;
+    std::vector<Byte> offset_high;
+    std::vector<Byte> offset_low;
+
+    std::size_t pos = 0;
+    for (const auto& token : parser_.parse(input, kWindowSize, kMaxMatchLength)) {
+        if (token.length >= kMinMatchLength) {
+            const std::size_t offset = token.offset - 1;
+            commands.push_back(static_cast<Byte>(token.length - 2));
+            offset_high.push_back(static_cast<Byte>(offset >> 8));
+            offset_low.push_back(static_cast<Byte>(offset & 0xFF));
+            pos += token.length;
+        } else {
+            commands.push_back(0);
+            literals.push_back(static_cast<Byte>(input[pos]));
+            ++pos;
+        }
+    }
+
+    std::vector<Byte> output;
+    output.push_back(kFormatTag);
+    write_varint(output, input.size());
+
+    write_stream(output, commands);
+    write_stream(output, literals);
+    write_stream(output, offset_high);
+    write_stream(output, offset_low);
+
+    return output;
+}
+
+std::string LzhCompressor::decompress(const std::vector<Byte>& input) {
+    if (input.empty()) {
+        return {};
+    }
+
+    const Byte* data = input.data();
+    const Byte* end = data + input.size();
+
+    const Byte tag = *data++;
+    if (tag == 0 || tag > kFormatTag) {
+        throw std::runtime_error("LZH: unsupported stream format");
+    }
+    const HuffmanFormat format = tag == 1 ? HuffmanFormat::Tree : HuffmanFormat::Canonical;
+    const std::uint64_t orig_len = read_varint(data, end);
+
+    std::array<std::string, kStreamCount> streams;
+    for (auto& stream : streams) {
+        stream = read_stream(data, end, format);
+    }
+    const std::string& commands = streams[0];
+    const std::string& literals = streams[1];
+    const std::string& offset_high = streams[2];
+    const std::string& offset_low = streams[3];
+
+    if (offset_high.size() != offset_low.size()) {
+        throw std::runtime_error("LZH: offset stream size mismatch");
+    }
+
+    std::string output(orig_len, '\0');
+    Byte* const out_begin = reinterpret_cast<Byte*>(output.data());
+    Byte* const out_end = out_begin + orig_len;
+    Byte* op = out_begin;
+
+    std::size_t literal_pos = 0;
+    std::size_t match_pos = 0;
+
+    for (unsigned char command : commands) {
+        if (command == 0) {
+            if (literal_pos >= literals.size() || op == out_end) {
+                throw std::runtime_error("LZH: invalid literal");
+            }
+            *op++ = static_cast<Byte>(literals[literal_pos++]);
+            continue;
+        }
+
+        if (match_pos >= offset_high.size()) {
+            throw std::runtime_error("LZH: ran out of offsets");
+        }
+        const std::size_t length = static_cast<std::size_t>(command) + 2;
+        const std::size_t high = static_cast<unsigned char>(offset_high[match_pos]);
+        const std::size_t low = static_cast<unsigned char>(offset_low[match_pos]);
+        const std::size_t offset = ((high << 8) | low) + 1;
+        ++match_pos;
+
+        if (offset > static_cast<std::size_t>(op - out_begin)) {
+            throw std::runtime_error("LZH: invalid match");
+        }
+        if (length > static_cast<std::size_t>(out_end - op)) {
+            throw std::runtime_error("LZH: match exceeds output size");
+        }
+
+        if (length + kWildCopyOverrun <= static_cast<std::size_t>(out_end - op)) {
+            copy_match(op, offset, length);
+        } else {
+            copy_match_exact(op, offset, length);
+        }
+        op += length;
+    }
+
+    if (op != out_end || literal_pos != literals.size() || match_pos != offset_high.size()) {
+        throw std::runtime_error("LZH: output size mismatch");
+    }
+
+    return output;
+}
+
+} // namespace compressup
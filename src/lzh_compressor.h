@@ -0,0 +1,38 @@
+#pragma once
+
+#include "compressor.h"
+#include "lzss_compressor.h"
+
+#include <cstdint>
+
+namespace compressup {
+
+// LZH: 类 Deflate 的混合编码器
+// 先用 LZSS 的匹配查找与解析得到字面量/匹配序列，再把命令、字面量、偏移拆成
+// 独立的字节流分别做 Huffman 编码，兼顾字典压缩的重复消除与熵编码的统计压缩。
+// 流格式为本库私有，与 RFC 1951 不兼容。
+class LzhCompressor : public ICompressor {
+public:
+    // 压缩级别直接传给内部的 LZSS 解析（查找器类型、搜索深度、解析策略）
+    explicit LzhCompressor(CompressionLevel level = CompressionLevel::Default);
+
+    std::string name() const override;
+    std::unique_ptr<ICompressor> clone() const override;
+    std::vector<Byte> compress(std::string_view input) override;
+    std::string decompress(const std::vector<Byte>& input) override;
+    std::uint8_t format_version() const override { return kFormatTag; }
+
+    // 流格式标签（流首字节），熵编码阶段的格式变化时递增：
+    // 1 = 各流使用 Huffman Tree 格式，2 = 各流使用 Huffman Canonical 格式
+    static constexpr Byte kFormatTag = 2;
+
+    static constexpr std::size_t kWindowSize = 32 * 1024;  // 回溯窗口
+    static constexpr std::size_t kMinMatchLength = 3;
+    // 命令符号 0 表示字面量，1..255 表示长度为 符号 + 2 的匹配
+    static constexpr std::size_t kMaxMatchLength = 257;
+
+private:
+    LzssCompressor parser_;
+};
+
+} // namespace compressup
@@ -1,40 +1,219 @@
 #include "lzss_compressor.h"
 
+#include "lz_copy.h"
+#include "match_finder.h"
+
 #include <algorithm>
+#include <cstdint>
+#include <optional>
 #include <stdexcept>
 
 namespace compressup {
 
+namespace {
+
+// 最优解析的代价（比特）：字面量 = 1 标志位 + 8 数据位，匹配 = 1 标志位 + 16 数据位
+constexpr std::uint32_t kLiteralCost = 9;
+constexpr std::uint32_t kMatchCost = 17;
+
+// 最优解析按块进行动态规划，限制临时数组的大小
+constexpr std::size_t kOptimalBlockSize = 64 * 1024;
+
+// 按位置顺序驱动匹配查找器：每个位置要么查找并插入，要么只插入
+class MatchCursor {
+public:
+    MatchCursor(std::string_view input, LzssCompressor::MatchFinderKind kind, std::size_t depth,
+                std::size_t window_size, std::size_t max_match_length)
+        : input_(input)
+        , max_match_length_(max_match_length) {
+        if (kind == LzssCompressor::MatchFinderKind::BinaryTree) {
+            tree_.emplace(window_size, max_match_length, depth);
+            tree_->reset(input);
+        } else {
+            chain_.emplace(window_size, depth);
+            chain_->reset(input);
+        }
+    }
+
+    // 查找当前位置的最长匹配，然后前进一个位置
+    Match find() {
+        Match match;
+        if (tree_) {
+            match = tree_->find_and_insert(pos_);
+        } else {
+            match = chain_->find(pos_, max_match_length_, max_match_length_);
+            chain_->insert(pos_);
+        }
+        ++pos_;
+        return match.length >= LzssCompressor::kMinMatchLength ? match : Match{};
+    }
+
+    // 跳过接下来的 count 个位置（仍需插入索引）
+    void skip(std::size_t count) {
+        for (std::size_t i = 0; i < count; ++i, ++pos_) {
+            if (tree_) {
+                tree_->insert(pos_);
+            } else {
+                chain_->insert(pos_);
+            }
+        }
+    }
+
+private:
+    std::string_view input_;
+    std::size_t max_match_length_;
+    std::size_t pos_ = 0;
+    std::optional<HashChainMatchFinder> chain_;
+    std::optional<BinaryTreeMatchFinder> tree_;
+};
+
+LzssCompressor::Token make_match(const Match& match) {
+    return {static_cast<std::uint16_t>(match.offset), static_cast<std::uint16_t>(match.length)};
+}
+
+} // namespace
+
+LzssCompressor::LzssCompressor(CompressionLevel level) {
+    switch (level) {
+    case CompressionLevel::Fastest:
+        finder_kind_ = MatchFinderKind::HashChain;
+        strategy_ = ParseStrategy::Greedy;
+        search_depth_ = 4;
+        break;
+    case CompressionLevel::Fast:
+        finder_kind_ = MatchFinderKind::HashChain;
+        strategy_ = ParseStrategy::Greedy;
+        search_depth_ = 16;
+        break;
+    case CompressionLevel::Default:
+        finder_kind_ = MatchFinderKind::BinaryTree;
+        strategy_ = ParseStrategy::Greedy;
+        search_depth_ = 32;
+        break;
+    case CompressionLevel::Better:
+        finder_kind_ = MatchFinderKind::BinaryTree;
+        strategy_ = ParseStrategy::Lazy;
+        search_depth_ = 64;
+        break;
+    case CompressionLevel::Best:
+    default:
+        finder_kind_ = MatchFinderKind::BinaryTree;
+        strategy_ = ParseStrategy::Optimal;
+        search_depth_ = 256;
+        break;
+    }
+}
+
 std::string LzssCompressor::name() const {
     return "lzss";
 }
 
-std::pair<std::size_t, std::size_t> LzssCompressor::find_longest_match(
-    std::string_view input, std::size_t pos) const {
-    
-    std::size_t best_offset = 0;
-    std::size_t best_length = 0;
-    
-    std::size_t search_start = (pos > kWindowSize) ? pos - kWindowSize : 0;
-    std::size_t max_match = std::min(kLookAheadSize, input.size() - pos);
-    
-    for (std::size_t i = search_start; i < pos; ++i) {
-        std::size_t length = 0;
-        while (length < max_match && input[i + length] == input[pos + length]) {
-            ++length;
-            // 允许超越当前位置的匹配（用于重复模式）
-            if (i + length >= pos) {
-                break;
+std::unique_ptr<ICompressor> LzssCompressor::clone() const {
+    return std::make_unique<LzssCompressor>(*this);
+}
+
+std::vector<LzssCompressor::Token> LzssCompressor::parse(std::string_view input,
+                                                         std::size_t window_size,
+                                                         std::size_t max_match_length) const {
+    if (strategy_ == ParseStrategy::Optimal) {
+        return parse_optimal(input, window_size, max_match_length);
+    }
+
+    std::vector<Token> tokens;
+    tokens.reserve(input.size() / 2 + 1);
+
+    const std::size_t n = input.size();
+    MatchCursor cursor(input, finder_kind_, search_depth_, window_size, max_match_length);
+
+    std::size_t pos = 0;
+    Match current = cursor.find();
+    while (pos < n) {
+        if (current.length == 0) {
+            tokens.push_back({0, 0});
+            ++pos;
+        } else if (strategy_ == ParseStrategy::Lazy &&
+                   current.length < max_match_length && pos + 1 < n) {
+            // 一步惰性匹配：下一位置的匹配更长时，当前位置改为字面量
+            Match next = cursor.find();
+            if (next.length > current.length) {
+                tokens.push_back({0, 0});
+                ++pos;
+                current = next;
+                continue;
             }
+            tokens.push_back(make_match(current));
+            cursor.skip(current.length - 2);
+            pos += current.length;
+        } else {
+            tokens.push_back(make_match(current));
+            cursor.skip(current.length - 1);
+            pos += current.length;
         }
-        
-        if (length > best_length) {
-            best_length = length;
-            best_offset = pos - i;
+
+        if (pos < n) {
+            current = cursor.find();
         }
     }
-    
-    return {best_offset, best_length};
+
+    return tokens;
+}
+
+std::vector<LzssCompressor::Token> LzssCompressor::parse_optimal(
+    std::string_view input, std::size_t window_size, std::size_t max_match_length) const {
+    std::vector<Token> tokens;
+    tokens.reserve(input.size() / 2 + 1);
+
+    const std::size_t n = input.size();
+    MatchCursor cursor(input, finder_kind_, search_depth_, window_size, max_match_length);
+
+    std::vector<Match> matches;
+    std::vector<std::uint32_t> cost;
+    std::vector<Token> choice;  // 到达每个位置的最后一个 token
+    std::vector<Token> block_tokens;
+
+    for (std::size_t block_start = 0; block_start < n; block_start += kOptimalBlockSize) {
+        const std::size_t block_len = std::min(kOptimalBlockSize, n - block_start);
+
+        // 块内每个位置的最长匹配；匹配的任意前缀（不短于最小长度）同样可用
+        matches.resize(block_len);
+        for (std::size_t i = 0; i < block_len; ++i) {
+            matches[i] = cursor.find();
+        }
+
+        cost.assign(block_len + 1, UINT32_MAX);
+        choice.assign(block_len + 1, Token{0, 0});
+        cost[0] = 0;
+
+        for (std::size_t i = 0; i < block_len; ++i) {
+            const std::uint32_t base = cost[i];
+
+            if (base + kLiteralCost < cost[i + 1]) {
+                cost[i + 1] = base + kLiteralCost;
+                choice[i + 1] = {0, 0};
+            }
+
+            // 匹配不跨越块边界
+            const std::size_t max_len = std::min(matches[i].length, block_len - i);
+            for (std::size_t len = kMinMatchLength; len <= max_len; ++len) {
+                if (base + kMatchCost <= cost[i + len]) {
+                    cost[i + len] = base + kMatchCost;
+                    choice[i + len] = {static_cast<std::uint16_t>(matches[i].offset),
+                                       static_cast<std::uint16_t>(len)};
+                }
+            }
+        }
+
+        // 从块尾回溯出 token 序列
+        block_tokens.clear();
+        for (std::size_t i = block_len; i > 0;) {
+            const Token& token = choice[i];
+            block_tokens.push_back(token);
+            i -= token.length == 0 ? 1 : token.length;
+        }
+        tokens.insert(tokens.end(), block_tokens.rbegin(), block_tokens.rend());
+    }
+
+    return tokens;
 }
 
 std::vector<Byte> LzssCompressor::compress(std::string_view input) {
@@ -57,21 +236,19 @@ std::vector<Byte> LzssCompressor::compress(std::string_view input) {
     Byte flag_byte = 0;
     int flag_bit = 0;
     
-    while (pos < input.size()) {
-        auto [offset, length] = find_longest_match(input, pos);
-        
-        if (length >= kMinMatchLength) {
+    for (const Token& token : parse(input, kWindowSize, kLookAheadSize)) {
+        if (token.length >= kMinMatchLength) {
             // 匹配: flag bit = 1
             flag_byte |= (1 << flag_bit);
             
             // 写入 offset (12 bits) 和 length - kMinMatchLength (4 bits) = 2 bytes
             std::uint16_t encoded = 
-                (static_cast<std::uint16_t>(offset - 1) << 4) | 
-                static_cast<std::uint16_t>(length - kMinMatchLength);
+                (static_cast<std::uint16_t>(token.offset - 1) << 4) | 
+                static_cast<std::uint16_t>(token.length - kMinMatchLength);
             temp_data.push_back(static_cast<Byte>(encoded >> 8));
             temp_data.push_back(static_cast<Byte>(encoded & 0xFF));
             
-            pos += length;
+            pos += token.length;
         } else {
             // 字面量: flag bit = 0
             temp_data.push_back(static_cast<Byte>(input[pos]));
@@ -135,20 +312,56 @@ std::string LzssCompressor::decompress(const std::vector<Byte>& input) {
     }
     
     const Byte* flags = data;
+    const Byte* const flags_end = flags + flag_count;
     data += flag_count;
     
-    std::string output;
-    output.reserve(orig_len);
+    // 每个数据字节最多产生 kLookAheadSize / 2 字节输出（匹配 2 字节、最长 kLookAheadSize）。
+    // 原始长度来自流头，超出该上限的流必然损坏，在分配输出之前拒绝
+    if (orig_len / (kLookAheadSize / 2) > static_cast<std::uint64_t>(end - data)) {
+        throw std::runtime_error("LZSS: original length exceeds payload");
+    }
+    
+    // 按原始长度一次性分配输出，直接写入
+    std::string output(orig_len, '\0');
+    Byte* const out_begin = reinterpret_cast<Byte*>(output.data());
+    Byte* const out_end = out_begin + orig_len;
+    Byte* op = out_begin;
     
-    std::size_t flag_index = 0;
+    // 快速路径：每次处理一个完整的标志字节（8 个 token，最多输出 8 * kLookAheadSize 字节、
+    // 读取 16 字节），输出与输入都离末尾足够远时，只需检查匹配偏移
+    constexpr std::size_t kFastOutputMargin = 8 * kLookAheadSize + kWildCopyOverrun;
+    Byte* const fast_out_end = orig_len > kFastOutputMargin ? out_end - kFastOutputMargin : out_begin;
+    
+    while (flags < flags_end && op < fast_out_end && end - data >= 16) {
+        unsigned flag_byte = *flags++;
+        for (int bit = 0; bit < 8; ++bit, flag_byte >>= 1) {
+            if (flag_byte & 1) {
+                std::uint16_t encoded = (static_cast<std::uint16_t>(data[0]) << 8) | data[1];
+                data += 2;
+                
+                std::size_t offset = (encoded >> 4) + 1;
+                std::size_t length = (encoded & 0x0F) + kMinMatchLength;
+                if (offset > static_cast<std::size_t>(op - out_begin)) {
+                    throw std::runtime_error("LZSS: invalid offset");
+                }
+                
+                copy_match(op, offset, length);
+                op += length;
+            } else {
+                *op++ = *data++;
+            }
+        }
+    }
+    
+    // 慢速路径：靠近缓冲区末尾时逐 token 检查边界
     int flag_bit = 0;
     
-    while (output.size() < orig_len && data < end) {
-        if (flag_index >= flag_count) {
+    while (op < out_end && data < end) {
+        if (flags >= flags_end) {
             throw std::runtime_error("LZSS: ran out of flags");
         }
         
-        bool is_match = (flags[flag_index] >> flag_bit) & 1;
+        bool is_match = (*flags >> flag_bit) & 1;
         
         if (is_match) {
             if (data + 2 > end) {
@@ -161,29 +374,25 @@ std::string LzssCompressor::decompress(const std::vector<Byte>& input) {
             std::size_t offset = (encoded >> 4) + 1;
             std::size_t length = (encoded & 0x0F) + kMinMatchLength;
             
-            if (offset > output.size()) {
+            if (offset > static_cast<std::size_t>(op - out_begin)) {
                 throw std::runtime_error("LZSS: invalid offset");
             }
             
-            std::size_t start = output.size() - offset;
-            for (std::size_t i = 0; i < length && output.size() < orig_len; ++i) {
-                output.push_back(output[start + i]);
-            }
+            length = std::min(length, static_cast<std::size_t>(out_end - op));
+            copy_match_exact(op, offset, length);
+            op += length;
         } else {
-            if (data >= end) {
-                throw std::runtime_error("LZSS: unexpected end of data");
-            }
-            output.push_back(static_cast<char>(*data++));
+            *op++ = *data++;
         }
         
         ++flag_bit;
         if (flag_bit == 8) {
-            ++flag_index;
+            ++flags;
             flag_bit = 0;
         }
     }
     
-    if (output.size() != orig_len) {
+    if (op != out_end) {
         throw std::runtime_error("LZSS: output size mismatch");
     }
     
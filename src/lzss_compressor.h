@@ -2,12 +2,20 @@
 
 #include "compressor.h"
 
+#include <cstdint>
+
 namespace compressup {
 
 // LZSS: LZ77的变体，只有当匹配长度超过阈值时才使用引用
 class LzssCompressor : public ICompressor {
 public:
+    // 压缩级别决定匹配查找器与解析策略：
+    // Fastest/Fast 使用浅哈希链 + 贪心解析，其余使用二叉树查找器，
+    // Better 使用一步惰性匹配，Best 使用基于代价的最优解析
+    explicit LzssCompressor(CompressionLevel level = CompressionLevel::Default);
+
     std::string name() const override;
+    std::unique_ptr<ICompressor> clone() const override;
     std::vector<Byte> compress(std::string_view input) override;
     std::string decompress(const std::vector<Byte>& input) override;
 
@@ -15,11 +23,38 @@ public:
     static constexpr std::size_t kWindowSize = 4096;     // 滑动窗口大小
     static constexpr std::size_t kLookAheadSize = 18;    // 前向缓冲区大小
     static constexpr std::size_t kMinMatchLength = 3;    // 最小匹配长度阈值
-    
+
+    // 匹配查找器类型
+    enum class MatchFinderKind {
+        HashChain,
+        BinaryTree,
+    };
+
+    // 解析策略
+    enum class ParseStrategy {
+        Greedy,   // 总是取当前位置的最长匹配
+        Lazy,     // 下一位置的匹配更长时先输出一个字面量
+        Optimal,  // 按实际的标志位/数据位代价做前向动态规划
+    };
+
+    // 解析结果：length 为 0 表示字面量
+    struct Token {
+        std::uint16_t offset;
+        std::uint16_t length;
+    };
+
+    // 将输入解析为字面量/匹配序列。LZSS 流自身使用 kWindowSize/kLookAheadSize，
+    // 混合编码器（LzhCompressor）以更大的窗口和匹配长度复用同一套解析
+    std::vector<Token> parse(std::string_view input, std::size_t window_size,
+                             std::size_t max_match_length) const;
+
 private:
-    // 查找最长匹配
-    std::pair<std::size_t, std::size_t> find_longest_match(
-        std::string_view input, std::size_t pos) const;
+    std::vector<Token> parse_optimal(std::string_view input, std::size_t window_size,
+                                     std::size_t max_match_length) const;
+
+    MatchFinderKind finder_kind_;
+    ParseStrategy strategy_;
+    std::size_t search_depth_;  // 哈希链深度或二叉树的 cut value
 };
 
 } // namespace compressup
@@ -1,13 +1,211 @@
 #include "lzw_compressor.h"
 
+#include "bit_stream.h"
+#include "lz_copy.h"
+#include "varint.h"
+
+#include <algorithm>
+#include <bit>
 #include <stdexcept>
+#include <vector>
 
 namespace compressup {
 
+namespace {
+
+// 编码器字典：以 (前缀编码, 下一字节) 为键的开放寻址哈希表。
+// 槽数为最大条目数的 2 倍以上的 2 的幂，一次分配，查找与插入都不需要构造字符串。
+class LzwDictionary {
+public:
+    explicit LzwDictionary(std::size_t max_entries) {
+        std::size_t size = 1;
+        unsigned bits = 0;
+        while (size < max_entries * 2) {
+            size <<= 1;
+            ++bits;
+        }
+        slots_.resize(size);
+        mask_ = size - 1;
+        shift_ = 32 - bits;
+    }
+
+    // 查找前缀 prefix 后接 byte 的条目，不存在时返回 kNotFound
+    std::uint32_t find(std::uint32_t prefix, Byte byte) const {
+        const std::uint32_t key = make_key(prefix, byte);
+        for (std::size_t i = slot_of(key);; i = (i + 1) & mask_) {
+            const Slot& slot = slots_[i];
+            if (slot.key == key) {
+                return slot.code;
+            }
+            if (slot.key == 0) {
+                return kNotFound;
+            }
+        }
+    }
+
+    void insert(std::uint32_t prefix, Byte byte, std::uint32_t code) {
+        const std::uint32_t key = make_key(prefix, byte);
+        std::size_t i = slot_of(key);
+        while (slots_[i].key != 0) {
+            i = (i + 1) & mask_;
+        }
+        slots_[i] = {key, code};
+    }
+
+    void clear() {
+        std::fill(slots_.begin(), slots_.end(), Slot{0, 0});
+    }
+
+    static constexpr std::uint32_t kNotFound = 0xFFFFFFFFu;
+
+private:
+    struct Slot {
+        std::uint32_t key;   // (prefix << 8 | byte) + 1，0 表示空槽
+        std::uint32_t code;
+    };
+
+    static std::uint32_t make_key(std::uint32_t prefix, Byte byte) {
+        return ((prefix << 8) | byte) + 1;
+    }
+
+    std::size_t slot_of(std::uint32_t key) const {
+        return static_cast<std::size_t>((key * 2654435761u) >> shift_) & mask_;
+    }
+
+    std::vector<Slot> slots_;
+    std::size_t mask_ = 0;
+    unsigned shift_ = 0;
+};
+
+// 解码器字典：条目不存储串本身，只记录 (该串在输出中的起始位置, 长度)。
+// 读到编码时新加入的条目是 "前一个串 + 当前串的首字节"，它在输出中紧接着前一个串
+// 出现，因此起始位置就是前一个串的写入位置；输出一个编码即从输出的更早位置复制一段，
+// 与 LZ77 的匹配复制相同，没有临时字符串，也不需要逐字节沿前缀链回溯。
+class LzwDecodeTable {
+public:
+    // 编码 [256, first_free) 为保留编码（如 CLEAR），不对应任何串
+    LzwDecodeTable(std::size_t max_entries, std::uint32_t first_free)
+        : entries_(max_entries)
+        , first_free_(first_free) {
+        for (std::uint32_t b = 0; b < 256; ++b) {
+            entries_[b] = {0, 1};
+        }
+        reset();
+    }
+
+    void reset() { size_ = first_free_; }
+
+    // 读到新编码时加入条目 "prev 的串 + 新编码的串的首字节"，prev_pos 为 prev 的串在输出中的位置；
+    // 字典已满时不加入。新编码恰为该条目时（cScSc）复制源与目标重叠，由 copy_match 处理
+    void add(std::uint32_t prev, std::size_t prev_pos) {
+        if (size_ < entries_.size()) {
+            entries_[size_++] = {static_cast<std::uint32_t>(prev_pos), entries_[prev].length + 1};
+        }
+    }
+
+    // 把 code 的串写到 out[pos, pos + 长度)，返回新的写入位置。limit 为输出总长，
+    // out 在 limit 之后还须有 kWildCopyOverrun 字节的空间
+    std::size_t write(std::uint32_t code, Byte* out, std::size_t pos, std::size_t limit) const {
+        if (code >= size_ || (code >= 256 && code < first_free_)) {
+            throw std::runtime_error("LZW: invalid code");
+        }
+        const Entry& entry = entries_[code];
+        if (entry.length > limit - pos) {
+            throw std::runtime_error("LZW: output size mismatch");
+        }
+        if (code < 256) {
+            out[pos] = static_cast<Byte>(code);
+        } else {
+            copy_match(out + pos, pos - entry.offset, entry.length);
+        }
+        return pos + entry.length;
+    }
+
+private:
+    struct Entry {
+        std::uint32_t offset;
+        std::uint32_t length;
+    };
+
+    std::vector<Entry> entries_;
+    std::uint32_t first_free_;
+    std::size_t size_ = 0;
+};
+
+// Variable 格式中第 index 个编码（自上次 CLEAR 起从 0 计数）的位宽。
+// 此前已加入 index 个条目，该编码最大可能为 256 + index（解码端正在建立的条目）
+unsigned variable_code_bits(std::size_t index, unsigned max_bits) {
+    return std::min<unsigned>(max_bits, static_cast<unsigned>(std::bit_width(256 + index)));
+}
+
+// code_count 个编码至多解出的字节数。新条目只比已有条目长 1 字节，第 k 个编码至多输出 k 字节，
+// 且不超过字典条目数；流头的原始长度超过它时流必然损坏，据此在分配输出之前拒绝
+std::uint64_t max_decoded_size(std::uint64_t code_count, std::uint64_t max_entries) {
+    const std::uint64_t ramp = std::min(code_count, max_entries);
+    return ramp * (ramp + 1) / 2 + (code_count - ramp) * max_entries;
+}
+
+} // namespace
+
+LzwCompressor::LzwCompressor(LzwFormat format)
+    : format_(format) {
+}
+
+LzwCompressor::LzwCompressor(CompressionLevel level, LzwFormat format)
+    : format_(format) {
+    // 重置检查本身几乎没有开销，级别只决定检查的频繁程度与阈值：级别越高对内容突变
+    // 反应越快（拼接的异构文件明显变小），在缓慢漂移的日志上则可能多重置几次
+    switch (level) {
+    case CompressionLevel::Fastest:
+        reset_check_interval_ = 32 * 1024;
+        reset_threshold_ = 0.85;
+        break;
+    case CompressionLevel::Fast:
+        reset_check_interval_ = 32 * 1024;
+        reset_threshold_ = 0.9;
+        break;
+    case CompressionLevel::Default:
+        reset_check_interval_ = 16 * 1024;
+        reset_threshold_ = 0.9;
+        break;
+    case CompressionLevel::Better:
+        reset_check_interval_ = 8 * 1024;
+        reset_threshold_ = 0.9;
+        break;
+    case CompressionLevel::Best:
+    default:
+        reset_check_interval_ = 8 * 1024;
+        reset_threshold_ = 0.95;
+        break;
+    }
+}
+
 std::string LzwCompressor::name() const {
     return "lzw";
 }
 
+std::unique_ptr<ICompressor> LzwCompressor::clone() const {
+    return std::make_unique<LzwCompressor>(*this);
+}
+
+std::uint8_t LzwCompressor::format_version() const {
+    return static_cast<std::uint8_t>(format_);
+}
+
+std::vector<Byte> LzwCompressor::compress(std::string_view input) {
+    if (input.empty()) {
+        return {};
+    }
+    return format_ == LzwFormat::Fixed ? compress_fixed(input) : compress_variable(input);
+}
+
+std::string LzwCompressor::decompress(const std::vector<Byte>& input) {
+    if (input.empty()) {
+        return {};
+    }
+    return format_ == LzwFormat::Fixed ? decompress_fixed(input) : decompress_variable(input);
+}
+
 void LzwCompressor::write_code(std::vector<Byte>& output, std::uint16_t code,
                                int& bit_buffer, int& bits_in_buffer) const {
     bit_buffer = (bit_buffer << kCodeBits) | code;
@@ -33,11 +231,7 @@ std::uint16_t LzwCompressor::read_code(const Byte*& data, const Byte* end,
     return (bit_buffer >> bits_in_buffer) & ((1 << kCodeBits) - 1);
 }
 
-std::vector<Byte> LzwCompressor::compress(std::string_view input) {
-    if (input.empty()) {
-        return {};
-    }
-    
+std::vector<Byte> LzwCompressor::compress_fixed(std::string_view input) const {
     std::vector<Byte> output;
     
     // 写入原始长度 (8字节, 小端序)
@@ -46,40 +240,35 @@ std::vector<Byte> LzwCompressor::compress(std::string_view input) {
         output.push_back(static_cast<Byte>(orig_len >> (i * 8)));
     }
     
-    // 初始化字典
-    std::unordered_map<std::string, std::uint16_t> dictionary;
-    for (std::size_t i = 0; i < kInitialDictSize; ++i) {
-        dictionary[std::string(1, static_cast<char>(i))] = static_cast<std::uint16_t>(i);
-    }
-    
-    std::uint16_t next_code = kInitialDictSize;
-    std::string current;
+    // 字典只存放多字节串，单字节串的编码即字节值本身；current 为当前串的编码
+    LzwDictionary dictionary(kMaxDictSize);
+    std::uint32_t next_code = kInitialDictSize;
+    std::uint32_t current = static_cast<unsigned char>(input[0]);
     
     int bit_buffer = 0;
     int bits_in_buffer = 0;
     
-    for (char c : input) {
-        std::string next_str = current + c;
+    for (std::size_t i = 1; i < input.size(); ++i) {
+        const auto c = static_cast<Byte>(input[i]);
+        const std::uint32_t code = dictionary.find(current, c);
         
-        if (dictionary.count(next_str)) {
-            current = next_str;
+        if (code != LzwDictionary::kNotFound) {
+            current = code;
         } else {
             // 输出当前字符串的编码
-            write_code(output, dictionary[current], bit_buffer, bits_in_buffer);
+            write_code(output, static_cast<std::uint16_t>(current), bit_buffer, bits_in_buffer);
             
             // 添加新字符串到字典
             if (next_code < kMaxDictSize) {
-                dictionary[next_str] = next_code++;
+                dictionary.insert(current, c, next_code++);
             }
             
-            current = std::string(1, c);
+            current = c;
         }
     }
     
     // 输出最后的字符串
-    if (!current.empty()) {
-        write_code(output, dictionary[current], bit_buffer, bits_in_buffer);
-    }
+    write_code(output, static_cast<std::uint16_t>(current), bit_buffer, bits_in_buffer);
     
     // 刷新剩余的位
     if (bits_in_buffer > 0) {
@@ -89,11 +278,7 @@ std::vector<Byte> LzwCompressor::compress(std::string_view input) {
     return output;
 }
 
-std::string LzwCompressor::decompress(const std::vector<Byte>& input) {
-    if (input.empty()) {
-        return {};
-    }
-    
+std::string LzwCompressor::decompress_fixed(const std::vector<Byte>& input) const {
     if (input.size() < 8) {
         throw std::runtime_error("LZW: input too short");
     }
@@ -107,61 +292,161 @@ std::string LzwCompressor::decompress(const std::vector<Byte>& input) {
         orig_len |= static_cast<std::uint64_t>(*data++) << (i * 8);
     }
     
-    // 初始化字典
-    std::vector<std::string> dictionary;
-    dictionary.reserve(kMaxDictSize);
-    for (std::size_t i = 0; i < kInitialDictSize; ++i) {
-        dictionary.emplace_back(1, static_cast<char>(i));
+    if (orig_len > max_decoded_size(static_cast<std::uint64_t>(end - data) * 8 / 12, kMaxDictSize)) {
+        throw std::runtime_error("LZW: original length exceeds payload");
     }
     
+    LzwDecodeTable dictionary(kMaxDictSize, kInitialDictSize);
+    
     int bit_buffer = 0;
     int bits_in_buffer = 0;
     
-    std::string output;
-    output.reserve(orig_len);
+    // 输出末尾预留匹配复制可能多写的字节，结束后截掉
+    std::string output(orig_len + kWildCopyOverrun, '\0');
+    auto* out = reinterpret_cast<Byte*>(output.data());
     
     // 读取第一个编码
-    std::uint16_t old_code = read_code(data, end, bit_buffer, bits_in_buffer);
-    if (old_code >= dictionary.size()) {
+    std::uint32_t old_code = read_code(data, end, bit_buffer, bits_in_buffer);
+    if (old_code >= kInitialDictSize) {
         throw std::runtime_error("LZW: invalid first code");
     }
+    std::size_t old_pos = 0;
+    std::size_t pos = dictionary.write(old_code, out, 0, orig_len);
     
-    output += dictionary[old_code];
-    std::string s = dictionary[old_code];
-    
-    while (output.size() < orig_len) {
-        std::uint16_t new_code;
+    while (pos < orig_len) {
+        std::uint32_t new_code;
         try {
             new_code = read_code(data, end, bit_buffer, bits_in_buffer);
         } catch (...) {
             break;
         }
         
-        std::string entry;
-        if (new_code < dictionary.size()) {
-            entry = dictionary[new_code];
-        } else if (new_code == dictionary.size()) {
-            // 特殊情况: cScSc
-            entry = s + s[0];
-        } else {
-            throw std::runtime_error("LZW: invalid code");
+        // 先加入新条目，cScSc 情况下 new_code 即为该条目
+        dictionary.add(old_code, old_pos);
+        old_pos = pos;
+        pos = dictionary.write(new_code, out, pos, orig_len);
+        old_code = new_code;
+    }
+    
+    if (pos != orig_len) {
+        throw std::runtime_error("LZW: output size mismatch");
+    }
+    output.resize(orig_len);
+    return output;
+}
+
+std::vector<Byte> LzwCompressor::compress_variable(std::string_view input) const {
+    // 格式：[varint 原始长度][变长编码比特流，高位在前]
+    std::vector<Byte> output;
+    output.reserve(input.size() / 2 + 16);
+    write_varint(output, input.size());
+    BitWriter writer(output);
+
+    LzwDictionary dictionary(kMaxVariableDictSize);
+    std::uint32_t next_code = kFirstVariableCode;
+    std::size_t code_index = 0;  // 自上次 CLEAR 起输出的编码数
+    std::uint32_t current = static_cast<unsigned char>(input[0]);
+
+    // 压缩率监测：字典填满后按区间比较输入字节数与输出比特数
+    std::uint64_t bits_written = 0;
+    std::size_t checkpoint_pos = 0;
+    std::uint64_t checkpoint_bits = 0;
+    double best_ratio = 0;
+
+    auto emit = [&](std::uint32_t code) {
+        const unsigned bits = variable_code_bits(code_index++, kMaxCodeBits);
+        writer.write(code, bits);
+        bits_written += bits;
+    };
+
+    for (std::size_t i = 1; i < input.size(); ++i) {
+        const auto c = static_cast<Byte>(input[i]);
+        const std::uint32_t code = dictionary.find(current, c);
+        if (code != LzwDictionary::kNotFound) {
+            current = code;
+            continue;
         }
-        
-        output += entry;
-        
-        // 添加新条目到字典
-        if (dictionary.size() < kMaxDictSize) {
-            dictionary.push_back(s + entry[0]);
+
+        emit(current);
+
+        bool reset = false;
+        if (next_code == kMaxVariableDictSize && i - checkpoint_pos >= reset_check_interval_) {
+            const double ratio = static_cast<double>(i - checkpoint_pos) * 8 /
+                                 static_cast<double>(bits_written - checkpoint_bits);
+            checkpoint_pos = i;
+            checkpoint_bits = bits_written;
+            reset = ratio < best_ratio * reset_threshold_;
+            best_ratio = std::max(best_ratio, ratio);
         }
-        
-        s = entry;
+
+        if (reset) {
+            emit(kClearCode);
+            dictionary.clear();
+            next_code = kFirstVariableCode;
+            code_index = 0;
+            best_ratio = 0;
+        } else if (next_code < kMaxVariableDictSize) {
+            dictionary.insert(current, c, next_code++);
+            if (next_code == kMaxVariableDictSize) {
+                // 字典刚填满，从此处开始监测
+                checkpoint_pos = i;
+                checkpoint_bits = bits_written;
+            }
+        }
+        current = c;
     }
-    
-    // 截断到原始长度
-    if (output.size() > orig_len) {
-        output.resize(orig_len);
+
+    emit(current);
+    writer.finish();
+    return output;
+}
+
+std::string LzwCompressor::decompress_variable(const std::vector<Byte>& input) const {
+    const Byte* data = input.data();
+    const Byte* end = data + input.size();
+    const std::uint64_t orig_len = read_varint(data, end);
+    // 编码位宽至少 9 位
+    if (orig_len > max_decoded_size(static_cast<std::uint64_t>(end - data) * 8 / 9, kMaxVariableDictSize)) {
+        throw std::runtime_error("LZW: original length exceeds payload");
     }
-    
+
+    // 256 号为 CLEAR，新条目从 257 开始
+    LzwDecodeTable dictionary(kMaxVariableDictSize, kFirstVariableCode);
+
+    // 输出末尾预留匹配复制可能多写的字节，结束后截掉
+    std::string output(orig_len + kWildCopyOverrun, '\0');
+    auto* out = reinterpret_cast<Byte*>(output.data());
+    std::size_t pos = 0;
+    std::size_t old_pos = 0;
+
+    BitReader reader(data, end);
+    std::size_t code_index = 0;
+    std::uint32_t old_code = 0;
+    while (pos < orig_len) {
+        reader.refill();
+        const std::uint32_t code = reader.read(variable_code_bits(code_index++, kMaxCodeBits));
+        if (reader.bits_consumed() > static_cast<std::uint64_t>(end - data) * 8) {
+            throw std::runtime_error("LZW: unexpected end of data");
+        }
+
+        if (code == kClearCode) {
+            dictionary.reset();
+            code_index = 0;
+            continue;
+        }
+        if (code_index == 1) {
+            // CLEAR 之后的第一个编码只能是单字节
+            if (code >= kInitialDictSize) {
+                throw std::runtime_error("LZW: invalid code");
+            }
+        } else {
+            dictionary.add(old_code, old_pos);
+        }
+        old_pos = pos;
+        pos = dictionary.write(code, out, pos, orig_len);
+        old_code = code;
+    }
+    output.resize(orig_len);
     return output;
 }
 
@@ -2,23 +2,55 @@
 
 #include "compressor.h"
 
-#include <unordered_map>
+#include <cstdint>
 
 namespace compressup {
 
+// LZW 流格式版本
+enum class LzwFormat : std::uint8_t {
+    Fixed = 1,     // 12 位定长编码，字典填满 4096 项后冻结
+    Variable = 2,  // 9–16 位变长编码，字典最大 65536 项，CLEAR 编码重置字典
+};
+
 class LzwCompressor : public ICompressor {
 public:
+    explicit LzwCompressor(LzwFormat format = LzwFormat::Variable);
+    // 压缩级别只影响 Variable 格式编码端的字典重置判断，流格式与解码器不变
+    explicit LzwCompressor(CompressionLevel level, LzwFormat format = LzwFormat::Variable);
+
     std::string name() const override;
+    std::unique_ptr<ICompressor> clone() const override;
     std::vector<Byte> compress(std::string_view input) override;
     std::string decompress(const std::vector<Byte>& input) override;
+    std::uint8_t format_version() const override;
+
+    // Variable 格式：字典填满后每处理 reset_check_interval 字节检查一次本区间的压缩率，
+    // 低于填满以来最佳值的 reset_threshold 倍时认为字典已过时，输出 CLEAR 重建字典
+    std::size_t reset_check_interval() const { return reset_check_interval_; }
+    double reset_threshold() const { return reset_threshold_; }
 
 private:
+    std::vector<Byte> compress_fixed(std::string_view input) const;
+    std::vector<Byte> compress_variable(std::string_view input) const;
+    std::string decompress_fixed(const std::vector<Byte>& input) const;
+    std::string decompress_variable(const std::vector<Byte>& input) const;
+
+    LzwFormat format_;
+    std::size_t reset_check_interval_ = 16 * 1024;
+    double reset_threshold_ = 0.9;
+
     // 初始字典大小 (0-255 的单字符)
     static constexpr std::size_t kInitialDictSize = 256;
     // 最大字典大小 (12位编码 = 4096)
     static constexpr std::size_t kMaxDictSize = 4096;
     // 编码位数
     static constexpr int kCodeBits = 12;
+
+    // Variable 格式：256 为 CLEAR，新条目从 257 开始；编码位宽随已输出的编码数从 9 增长到 16
+    static constexpr std::uint32_t kClearCode = 256;
+    static constexpr std::uint32_t kFirstVariableCode = 257;
+    static constexpr std::size_t kMaxVariableDictSize = 65536;
+    static constexpr unsigned kMaxCodeBits = 16;
     
     // 将编码写入比特流
     void write_code(std::vector<Byte>& output, std::uint16_t code, 
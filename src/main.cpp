@@ -9,7 +9,8 @@ namespace {
 
 void print_usage() {
     std::cout << "Usage:\n"
-              << "  compressup_cli compress --algo <name> <input> <output>\n"
+              << "  compressup_cli compress --algo <name> [--level <level>] <input> <output>\n"
+              << "    level: fastest|fast|default|better|best or 1-12 (default: default)\n"
               << "  compressup_cli decompress <input> <output>\n"
               << "  compressup_cli list-algorithms\n";
 }
@@ -28,7 +29,7 @@ int main(int argc, char** argv) {
 
     try {
         if (command == "compress") {
-            if (argc != 6) {
+            if (argc != 6 && argc != 8) {
                 print_usage();
                 return 1;
             }
@@ -40,10 +41,23 @@ int main(int argc, char** argv) {
             }
 
             std::string algorithm_name = argv[3];
-            std::string input_path = argv[4];
-            std::string output_path = argv[5];
+            CompressionLevel level = CompressionLevel::Default;
+            int path_index = 4;
 
-            compress_file(input_path, output_path, algorithm_name);
+            if (argc == 8) {
+                std::string level_flag = argv[4];
+                if (level_flag != "--level") {
+                    print_usage();
+                    return 1;
+                }
+                level = compression_level_from_string(argv[5]);
+                path_index = 6;
+            }
+
+            std::string input_path = argv[path_index];
+            std::string output_path = argv[path_index + 1];
+
+            compress_file(input_path, output_path, algorithm_name, level);
             return 0;
         } else if (command == "decompress") {
             if (argc != 4) {
@@ -0,0 +1,183 @@
+#include "match_finder.h"
+
+#include "match_length.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace compressup {
+
+HashChainMatchFinder::HashChainMatchFinder(std::size_t window_size, std::size_t max_chain_depth)
+    : window_size_(window_size)
+    , max_chain_depth_(std::max<std::size_t>(max_chain_depth, 1))
+    , head_(std::size_t{1} << kHashBits, kNil)
+    , prev_(window_size, kNil) {
+
+    if (window_size == 0 || (window_size & (window_size - 1)) != 0) {
+        throw std::invalid_argument("HashChainMatchFinder: window size must be a power of two");
+    }
+}
+
+void HashChainMatchFinder::reset(std::string_view input) {
+    if (input.size() >= kNil) {
+        throw std::invalid_argument("HashChainMatchFinder: input too large");
+    }
+
+    input_ = input;
+    std::fill(head_.begin(), head_.end(), kNil);
+    std::fill(prev_.begin(), prev_.end(), kNil);
+}
+
+std::uint32_t HashChainMatchFinder::hash(std::size_t pos) const {
+    std::uint32_t v = static_cast<std::uint32_t>(static_cast<unsigned char>(input_[pos])) |
+                      static_cast<std::uint32_t>(static_cast<unsigned char>(input_[pos + 1])) << 8 |
+                      static_cast<std::uint32_t>(static_cast<unsigned char>(input_[pos + 2])) << 16;
+    return (v * 2654435761u) >> (32 - kHashBits);
+}
+
+void HashChainMatchFinder::insert(std::size_t pos) {
+    // 剩余不足 3 字节的位置不可能成为匹配起点
+    if (pos + kMinMatch > input_.size()) {
+        return;
+    }
+
+    std::uint32_t h = hash(pos);
+    prev_[pos & (window_size_ - 1)] = head_[h];
+    head_[h] = static_cast<std::uint32_t>(pos);
+}
+
+Match HashChainMatchFinder::find(std::size_t pos, std::size_t max_length,
+                                 std::size_t nice_length) const {
+    Match best;
+    max_length = std::min(max_length, input_.size() - pos);
+    const Byte* data = reinterpret_cast<const Byte*>(input_.data());
+
+    for_each_candidate(pos, [&](std::size_t candidate) {
+        std::size_t length = match_length(data + candidate, data + pos, max_length);
+
+        if (length > best.length) {
+            best.length = length;
+            best.offset = pos - candidate;
+        }
+        return best.length < nice_length;
+    });
+
+    return best;
+}
+
+BinaryTreeMatchFinder::BinaryTreeMatchFinder(std::size_t window_size,
+                                             std::size_t max_match_length,
+                                             std::size_t cut_value)
+    : window_size_(window_size)
+    , cyclic_size_(window_size + 1)
+    , max_match_length_(max_match_length)
+    , cut_value_(std::max<std::size_t>(cut_value, 1))
+    , head_(std::size_t{1} << kHashBits, kNil)
+    , son_(2 * cyclic_size_, kNil) {
+
+    if (window_size == 0 || max_match_length < kMinMatch) {
+        throw std::invalid_argument("BinaryTreeMatchFinder: invalid parameters");
+    }
+}
+
+void BinaryTreeMatchFinder::reset(std::string_view input) {
+    if (input.size() >= kNil) {
+        throw std::invalid_argument("BinaryTreeMatchFinder: input too large");
+    }
+
+    input_ = input;
+    std::fill(head_.begin(), head_.end(), kNil);
+    std::fill(son_.begin(), son_.end(), kNil);
+}
+
+std::uint32_t BinaryTreeMatchFinder::hash(std::size_t pos) const {
+    std::uint32_t v = static_cast<std::uint32_t>(static_cast<unsigned char>(input_[pos])) |
+                      static_cast<std::uint32_t>(static_cast<unsigned char>(input_[pos + 1])) << 8 |
+                      static_cast<std::uint32_t>(static_cast<unsigned char>(input_[pos + 2])) << 16;
+    return (v * 2654435761u) >> (32 - kHashBits);
+}
+
+Match BinaryTreeMatchFinder::find_and_insert(std::size_t pos) {
+    return update(pos);
+}
+
+void BinaryTreeMatchFinder::insert(std::size_t pos) {
+    update(pos);
+}
+
+Match BinaryTreeMatchFinder::update(std::size_t pos) {
+    Match best;
+
+    const std::size_t len_limit = std::min(max_match_length_, input_.size() - pos);
+    if (len_limit < kMinMatch) {
+        return best;
+    }
+
+    const std::uint32_t h = hash(pos);
+    std::uint32_t cur_match = head_[h];
+    head_[h] = static_cast<std::uint32_t>(pos);
+
+    const std::size_t cyclic_pos = pos % cyclic_size_;
+    // ptr1 收集比当前后缀小的子树，ptr0 收集比当前后缀大的子树
+    std::uint32_t* ptr0 = &son_[2 * cyclic_pos + 1];
+    std::uint32_t* ptr1 = &son_[2 * cyclic_pos];
+    std::size_t len0 = 0;
+    std::size_t len1 = 0;
+    std::size_t depth = cut_value_;
+
+    const Byte* data = reinterpret_cast<const Byte*>(input_.data());
+    const Byte* cur = data + pos;
+
+    while (true) {
+        if (cur_match == kNil || pos - cur_match > window_size_ || depth-- == 0) {
+            *ptr0 = kNil;
+            *ptr1 = kNil;
+            break;
+        }
+
+        const std::size_t delta = pos - cur_match;
+        const std::size_t match_cyclic = cyclic_pos >= delta
+            ? cyclic_pos - delta
+            : cyclic_pos + cyclic_size_ - delta;
+        std::uint32_t* pair = &son_[2 * match_cyclic];
+        const Byte* pb = data + cur_match;
+
+        // 左右边界各自已知的公共前缀长度，取较小者即可跳过
+        std::size_t len = std::min(len0, len1);
+        if (pb[len] == cur[len]) {
+            ++len;
+            len += match_length(pb + len, cur + len, len_limit - len);
+
+            if (len > best.length) {
+                best.length = len;
+                best.offset = delta;
+            }
+
+            // 完全相同的节点被当前位置取代，继承其左右子树
+            if (len == len_limit) {
+                *ptr1 = pair[0];
+                *ptr0 = pair[1];
+                break;
+            }
+        }
+
+        if (pb[len] < cur[len]) {
+            *ptr1 = cur_match;
+            ptr1 = pair + 1;
+            cur_match = *ptr1;
+            len1 = len;
+        } else {
+            *ptr0 = cur_match;
+            ptr0 = pair;
+            cur_match = *ptr0;
+            len0 = len;
+        }
+    }
+
+    if (best.length < kMinMatch) {
+        best = Match{};
+    }
+    return best;
+}
+
+} // namespace compressup
@@ -0,0 +1,119 @@
+#pragma once
+
+#include "types.h"
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace compressup {
+
+// 匹配结果：offset 为回溯距离，length 为匹配长度（0 表示没有匹配）
+struct Match {
+    std::size_t offset{0};
+    std::size_t length{0};
+};
+
+// 哈希链匹配查找器
+// 以后续 3 字节的哈希作为索引，每个位置通过 prev 链接到窗口内上一个同哈希的位置，
+// 查找时只需沿链访问少量候选，而不是扫描整个窗口。
+class HashChainMatchFinder {
+public:
+    // window_size 必须为 2 的幂；max_chain_depth 为每次查找最多访问的候选数
+    HashChainMatchFinder(std::size_t window_size, std::size_t max_chain_depth);
+
+    // 绑定新的输入并清空索引
+    void reset(std::string_view input);
+
+    // 将位置 pos 加入索引，必须按位置递增顺序调用
+    void insert(std::size_t pos);
+
+    // 按由近到远的顺序访问窗口内的候选位置（不包括 pos 本身），
+    // visit(candidate) 返回 false 时提前结束
+    template<typename Visit>
+    void for_each_candidate(std::size_t pos, Visit&& visit) const;
+
+    // 查找最长匹配（长度相同时取较近的候选），达到 nice_length 即停止搜索
+    Match find(std::size_t pos, std::size_t max_length, std::size_t nice_length) const;
+
+    std::size_t window_size() const { return window_size_; }
+    std::size_t max_chain_depth() const { return max_chain_depth_; }
+
+    static constexpr std::size_t kHashBits = 15;
+    static constexpr std::size_t kMinMatch = 3;
+
+private:
+    static constexpr std::uint32_t kNil = 0xFFFFFFFFu;
+
+    std::uint32_t hash(std::size_t pos) const;
+
+    std::string_view input_;
+    std::size_t window_size_;
+    std::size_t max_chain_depth_;
+    std::vector<std::uint32_t> head_;
+    std::vector<std::uint32_t> prev_;  // 按 pos & (window_size - 1) 循环使用
+};
+
+// 二叉树匹配查找器（类似 LZMA 的 BT 查找器）
+// 窗口内同哈希的位置按其后缀的字典序组织成二叉查找树，每次查找从根向下走一条路径，
+// 同时把当前位置作为新根插入，平均只需对数次比较即可找到最长匹配。
+class BinaryTreeMatchFinder {
+public:
+    // max_match_length 为匹配长度上限，cut_value 为每次查找最多比较的节点数
+    BinaryTreeMatchFinder(std::size_t window_size, std::size_t max_match_length,
+                          std::size_t cut_value);
+
+    // 绑定新的输入并清空索引
+    void reset(std::string_view input);
+
+    // 查找 pos 处的最长匹配并将 pos 插入树中，必须对每个位置按递增顺序调用
+    Match find_and_insert(std::size_t pos);
+
+    // 只插入 pos（用于匹配内部的位置），同样必须按顺序调用
+    void insert(std::size_t pos);
+
+    static constexpr std::size_t kHashBits = 16;
+    static constexpr std::size_t kMinMatch = 3;
+
+private:
+    static constexpr std::uint32_t kNil = 0xFFFFFFFFu;
+
+    std::uint32_t hash(std::size_t pos) const;
+    Match update(std::size_t pos);
+
+    std::string_view input_;
+    std::size_t window_size_;
+    std::size_t cyclic_size_;  // window_size + 1，保证窗口内每个位置有独立的节点
+    std::size_t max_match_length_;
+    std::size_t cut_value_;
+    std::vector<std::uint32_t> head_;
+    std::vector<std::uint32_t> son_;  // 每个节点两个子指针：[左, 右]
+};
+
+} // namespace compressup
+
+// 模板实现
+namespace compressup {
+
+template<typename Visit>
+void HashChainMatchFinder::for_each_candidate(std::size_t pos, Visit&& visit) const {
+    if (pos + kMinMatch > input_.size()) {
+        return;
+    }
+
+    std::uint32_t candidate = head_[hash(pos)];
+    std::size_t depth = max_chain_depth_;
+
+    // 窗口内每个候选的 prev 槽位尚未被覆盖，超出窗口即停止
+    while (candidate != kNil && depth-- > 0) {
+        if (pos - candidate > window_size_) {
+            break;
+        }
+        if (!visit(static_cast<std::size_t>(candidate))) {
+            break;
+        }
+        candidate = prev_[candidate & (window_size_ - 1)];
+    }
+}
+
+} // namespace compressup
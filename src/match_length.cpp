@@ -0,0 +1,109 @@
+#include "match_length.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define COMPRESSUP_X86 1
+#endif
+
+namespace compressup {
+
+namespace {
+
+using MatchLengthFn = std::size_t (*)(const Byte*, const Byte*, std::size_t);
+
+std::size_t match_length_scalar(const Byte* a, const Byte* b, std::size_t limit) {
+    std::size_t len = 0;
+
+    while (len + 8 <= limit) {
+        std::uint64_t wa;
+        std::uint64_t wb;
+        std::memcpy(&wa, a + len, 8);
+        std::memcpy(&wb, b + len, 8);
+        std::uint64_t diff = wa ^ wb;
+        if (diff != 0) {
+            return len + detail::first_diff_byte(diff);
+        }
+        len += 8;
+    }
+
+    while (len < limit && a[len] == b[len]) {
+        ++len;
+    }
+    return len;
+}
+
+#ifdef COMPRESSUP_X86
+
+std::size_t match_length_sse2(const Byte* a, const Byte* b, std::size_t limit) {
+    std::size_t len = 0;
+
+    while (len + 16 <= limit) {
+        __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + len));
+        __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + len));
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(va, vb)));
+        if (mask != 0xFFFFu) {
+            return len + static_cast<std::size_t>(std::countr_zero(~mask));
+        }
+        len += 16;
+    }
+
+    return len + match_length_scalar(a + len, b + len, limit - len);
+}
+
+__attribute__((target("avx2")))
+std::size_t match_length_avx2(const Byte* a, const Byte* b, std::size_t limit) {
+    std::size_t len = 0;
+
+    while (len + 32 <= limit) {
+        __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + len));
+        __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + len));
+        unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(va, vb)));
+        if (mask != 0xFFFFFFFFu) {
+            return len + static_cast<std::size_t>(std::countr_zero(~mask));
+        }
+        len += 32;
+    }
+
+    return len + match_length_sse2(a + len, b + len, limit - len);
+}
+
+#endif
+
+struct Kernel {
+    MatchLengthFn fn;
+    const char* name;
+};
+
+Kernel select_kernel() {
+#ifdef COMPRESSUP_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return {match_length_avx2, "avx2"};
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return {match_length_sse2, "sse2"};
+    }
+#endif
+    return {match_length_scalar, "scalar"};
+}
+
+const Kernel& kernel() {
+    static const Kernel selected = select_kernel();
+    return selected;
+}
+
+} // namespace
+
+namespace detail {
+
+std::size_t match_length_wide(const Byte* a, const Byte* b, std::size_t limit) {
+    return kernel().fn(a, b, limit);
+}
+
+} // namespace detail
+
+const char* match_length_kernel() {
+    return kernel().name;
+}
+
+} // namespace compressup
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "types.h"
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace compressup {
+
+namespace detail {
+
+// 两个 64 位字异或后，内存顺序上第一个不同字节的下标
+inline std::size_t first_diff_byte(std::uint64_t diff) {
+    if constexpr (std::endian::native == std::endian::little) {
+        return static_cast<std::size_t>(std::countr_zero(diff)) >> 3;
+    } else {
+        return static_cast<std::size_t>(std::countl_zero(diff)) >> 3;
+    }
+}
+
+// 按 CPU 能力选择的向量化实现
+std::size_t match_length_wide(const Byte* a, const Byte* b, std::size_t limit);
+
+} // namespace detail
+
+// 返回 a 与 b 的公共前缀长度（不超过 limit），LZ 系列的匹配扩展共用此函数。
+// 前 8 字节内联比较（多数候选在此失配），更长的匹配在运行时按 CPU 能力
+// 选用 AVX2（32 字节）、SSE2（16 字节）或 8 字节标量实现；
+// 调用方需保证 a[0, limit) 与 b[0, limit) 均可读。
+inline std::size_t match_length(const Byte* a, const Byte* b, std::size_t limit) {
+    if (limit >= 8) {
+        std::uint64_t wa;
+        std::uint64_t wb;
+        std::memcpy(&wa, a, 8);
+        std::memcpy(&wb, b, 8);
+        if (std::uint64_t diff = wa ^ wb) {
+            return detail::first_diff_byte(diff);
+        }
+        return 8 + detail::match_length_wide(a + 8, b + 8, limit - 8);
+    }
+
+    std::size_t len = 0;
+    while (len < limit && a[len] == b[len]) {
+        ++len;
+    }
+    return len;
+}
+
+// 当前选用的实现名称："avx2"、"sse2" 或 "scalar"
+const char* match_length_kernel();
+
+} // namespace compressup
@@ -7,6 +7,15 @@
 
 namespace compressup {
 
+namespace {
+
+// 并行流：[魔数][版本][内层流格式版本][8 字节原始总长度][4 字节块数][块头与块数据...]
+// 版本 1 没有内层流格式版本一字节
+constexpr Byte kParallelMagic = 0xC4;
+constexpr Byte kParallelVersion = 0x02;
+
+} // namespace
+
 // ThreadPool 实现
 ThreadPool::ThreadPool(std::size_t num_threads) {
     if (num_threads == 0) {
@@ -69,6 +78,10 @@ std::string ParallelCompressor::name() const {
     return "parallel_" + base_compressor_->name();
 }
 
+std::unique_ptr<ICompressor> ParallelCompressor::clone() const {
+    return std::make_unique<ParallelCompressor>(base_compressor_->clone(), block_size_, num_threads_);
+}
+
 std::vector<Byte> ParallelCompressor::compress(std::string_view input) {
     return compress_with_progress(input, nullptr);
 }
@@ -86,9 +99,10 @@ std::vector<Byte> ParallelCompressor::compress_with_progress(
         
         std::vector<Byte> output;
         
-        // 写入魔数和版本
-        output.push_back(0xC4);  // 并行压缩魔数
-        output.push_back(0x01);  // 版本号
+        // 写入魔数、版本和内层算法的流格式版本
+        output.push_back(kParallelMagic);
+        output.push_back(kParallelVersion);
+        output.push_back(base_compressor_->format_version());
         
         // 写入原始总长度
         std::uint64_t total_size = input.size();
@@ -130,8 +144,9 @@ std::vector<Byte> ParallelCompressor::compress_with_progress(
     std::vector<std::future<std::vector<Byte>>> futures;
     std::atomic<std::size_t> processed{0};
     
+    // 各块使用 base_compressor_ 的副本：压缩级别与流格式相同，与头中记录的版本一致
     for (const auto& block : blocks) {
-        auto compressor = create_compressor(base_compressor_->name());
+        auto compressor = base_compressor_->clone();
         futures.push_back(pool.submit([this, block, &processed, &callback, 
                                        total = input.size(),
                                        comp = std::move(compressor)]() mutable {
@@ -153,9 +168,10 @@ std::vector<Byte> ParallelCompressor::compress_with_progress(
     // 构建输出
     std::vector<Byte> output;
     
-    // 写入魔数和版本
-    output.push_back(0xC4);
-    output.push_back(0x01);
+    // 写入魔数、版本和内层算法的流格式版本
+    output.push_back(kParallelMagic);
+    output.push_back(kParallelVersion);
+    output.push_back(base_compressor_->format_version());
     
     // 写入原始总长度
     std::uint64_t total_size = input.size();
@@ -207,13 +223,21 @@ std::string ParallelCompressor::decompress_with_progress(
     const Byte* data = input.data();
     const Byte* end = data + input.size();
     
-    // 验证魔数和版本
-    if (*data++ != 0xC4) {
+    // 验证魔数和版本；版本 1 的头不记录内层格式，当时各算法都只有流格式 1
+    if (*data++ != kParallelMagic) {
         throw std::runtime_error("ParallelCompressor: invalid magic number");
     }
-    if (*data++ != 0x01) {
+    const Byte version = *data++;
+    std::uint8_t format_version = 1;
+    if (version == kParallelVersion) {
+        if (input.size() < 15) {
+            throw std::runtime_error("ParallelCompressor: input too short");
+        }
+        format_version = *data++;
+    } else if (version != 0x01) {
         throw std::runtime_error("ParallelCompressor: unsupported version");
     }
+    const AlgorithmId algorithm = algorithm_id_from_name(base_compressor_->name());
     
     // 读取原始总长度
     std::uint64_t total_size = 0;
@@ -258,7 +282,7 @@ std::string ParallelCompressor::decompress_with_progress(
     std::atomic<std::size_t> processed{0};
     
     for (const auto& [orig_size, comp_data] : blocks) {
-        auto compressor = create_compressor(base_compressor_->name());
+        auto compressor = create_decompressor(algorithm, format_version);
         futures.push_back(pool.submit([this, orig_size, &comp_data, 
                                        &processed, &callback, total_size,
                                        comp = std::move(compressor)]() mutable {
@@ -285,8 +309,9 @@ std::string ParallelCompressor::decompress_with_progress(
 std::vector<Byte> parallel_compress(std::string_view input,
                                     const std::string& algorithm,
                                     std::size_t block_size,
-                                    std::size_t num_threads) {
-    auto base = create_compressor(algorithm);
+                                    std::size_t num_threads,
+                                    CompressionLevel level) {
+    auto base = create_compressor(algorithm, level);
     ParallelCompressor parallel(std::move(base), block_size, num_threads);
     return parallel.compress(input);
 }
@@ -47,6 +47,7 @@ public:
                        std::size_t num_threads = 0);
     
     std::string name() const override;
+    std::unique_ptr<ICompressor> clone() const override;
     std::vector<Byte> compress(std::string_view input) override;
     std::string decompress(const std::vector<Byte>& input) override;
     
@@ -72,7 +73,8 @@ private:
 std::vector<Byte> parallel_compress(std::string_view input, 
                                     const std::string& algorithm,
                                     std::size_t block_size = 64 * 1024,
-                                    std::size_t num_threads = 0);
+                                    std::size_t num_threads = 0,
+                                    CompressionLevel level = CompressionLevel::Default);
 
 std::string parallel_decompress(const std::vector<Byte>& input,
                                 const std::string& algorithm);
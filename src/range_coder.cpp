@@ -0,0 +1,99 @@
+#include "range_coder.h"
+
+#include <stdexcept>
+
+namespace compressup {
+
+AdaptiveByteModel::AdaptiveByteModel() {
+    freq_.fill(1);
+    rescale();
+}
+
+std::uint32_t AdaptiveByteModel::cumulative(std::size_t symbol) const {
+    std::uint32_t sum = 0;
+    for (std::size_t i = symbol; i > 0; i &= i - 1) {
+        sum += tree_[i];
+    }
+    return sum;
+}
+
+std::size_t AdaptiveByteModel::find(std::uint32_t target, std::uint32_t& cum) const {
+    // 自顶向下二分 Fenwick 树，找到累计频率不超过 target 的最后位置，途经的节点之和即累计频率
+    std::size_t pos = 0;
+    cum = 0;
+    for (std::size_t step = 256; step > 0; step >>= 1) {
+        const std::size_t next = pos + step;
+        if (next <= 256 && cum + tree_[next] <= target) {
+            cum += tree_[next];
+            pos = next;
+        }
+    }
+    return pos;
+}
+
+void AdaptiveByteModel::update(std::size_t symbol) {
+    freq_[symbol] += kIncrement;
+    total_ += kIncrement;
+    for (std::size_t i = symbol + 1; i <= 256; i += i & (0 - i)) {
+        tree_[i] += kIncrement;
+    }
+    if (total_ > kMaxTotal) {
+        rescale();
+    }
+}
+
+void AdaptiveByteModel::rescale() {
+    total_ = 0;
+    for (auto& f : freq_) {
+        f = (f + 1) / 2;
+        total_ += f;
+    }
+
+    // 由频率重建 Fenwick 树
+    tree_.fill(0);
+    for (std::size_t i = 1; i <= 256; ++i) {
+        tree_[i] += freq_[i - 1];
+        const std::size_t parent = i + (i & (0 - i));
+        if (parent <= 256) {
+            tree_[parent] += tree_[i];
+        }
+    }
+}
+
+void AdaptiveByteModel::encode(RangeEncoder& encoder, Byte symbol) {
+    encoder.encode(cumulative(symbol), freq_[symbol], total_);
+    update(symbol);
+}
+
+Byte AdaptiveByteModel::decode(RangeDecoder& decoder) {
+    const std::uint32_t target = decoder.decode_freq(total_);
+    std::uint32_t cum = 0;
+    const std::size_t symbol = find(target, cum);
+    decoder.decode(cum, freq_[symbol]);
+    update(symbol);
+    return static_cast<Byte>(symbol);
+}
+
+void range_encode_bytes(std::vector<Byte>& output, const Byte* data, std::size_t size) {
+    RangeEncoder encoder(output);
+    AdaptiveByteModel model;
+    for (std::size_t i = 0; i < size; ++i) {
+        model.encode(encoder, data[i]);
+    }
+    encoder.finish();
+}
+
+std::vector<Byte> range_decode_bytes(const Byte* data, const Byte* end, std::size_t count) {
+    std::vector<Byte> output(count);
+    RangeDecoder decoder(data, end);
+    AdaptiveByteModel model;
+    for (std::size_t i = 0; i < count; ++i) {
+        output[i] = model.decode(decoder);
+    }
+    if (decoder.overrun() > 0) {
+        throw std::runtime_error("Range coder: truncated input");
+    }
+    return output;
+}
+
+} // namespace compressup
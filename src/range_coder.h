@@ -0,0 +1,130 @@
+#pragma once
+
+#include "types.h"
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace compressup {
+
+// 区间编码器（Subbotin 式无进位实现）
+// low/range 均为 32 位；low 的高 8 位在之后不可能再变化时即输出，区间过小
+// （range < kBottom）时直接截断区间，因此不需要处理进位。频率总和不得超过 kBottom。
+class RangeEncoder {
+public:
+    static constexpr std::uint32_t kTop = std::uint32_t{1} << 24;
+    static constexpr std::uint32_t kBottom = std::uint32_t{1} << 16;
+
+    explicit RangeEncoder(std::vector<Byte>& output)
+        : output_(output) {
+    }
+
+    // 编码累计频率为 cum、频率为 freq 的符号，total 为频率总和
+    void encode(std::uint32_t cum, std::uint32_t freq, std::uint32_t total) {
+        range_ /= total;
+        low_ += cum * range_;
+        range_ *= freq;
+        while ((low_ ^ (low_ + range_)) < kTop ||
+               (range_ < kBottom && ((range_ = (0u - low_) & (kBottom - 1)), true))) {
+            output_.push_back(static_cast<Byte>(low_ >> 24));
+            low_ <<= 8;
+            range_ <<= 8;
+        }
+    }
+
+    // 写出 low 的剩余 4 字节
+    void finish() {
+        for (int i = 0; i < 4; ++i) {
+            output_.push_back(static_cast<Byte>(low_ >> 24));
+            low_ <<= 8;
+        }
+    }
+
+private:
+    std::vector<Byte>& output_;
+    std::uint32_t low_ = 0;
+    std::uint32_t range_ = 0xFFFFFFFFu;
+};
+
+class RangeDecoder {
+public:
+    // 输入末尾之后按 0 读取，调用方通过 overrun() 检查数据是否被截断
+    RangeDecoder(const Byte* data, const Byte* end)
+        : data_(data)
+        , end_(end) {
+        for (int i = 0; i < 4; ++i) {
+            code_ = (code_ << 8) | next_byte();
+        }
+    }
+
+    // 返回当前符号的累计频率目标值，之后必须以该符号调用 decode
+    std::uint32_t decode_freq(std::uint32_t total) {
+        range_ /= total;
+        const std::uint32_t value = (code_ - low_) / range_;
+        return value < total ? value : total - 1;
+    }
+
+    void decode(std::uint32_t cum, std::uint32_t freq) {
+        low_ += cum * range_;
+        range_ *= freq;
+        while ((low_ ^ (low_ + range_)) < RangeEncoder::kTop ||
+               (range_ < RangeEncoder::kBottom &&
+                ((range_ = (0u - low_) & (RangeEncoder::kBottom - 1)), true))) {
+            code_ = (code_ << 8) | next_byte();
+            low_ <<= 8;
+            range_ <<= 8;
+        }
+    }
+
+    // 读取越过输入末尾的字节数（编码器末尾写出的 4 字节之外不应再读取）
+    std::size_t overrun() const { return overrun_; }
+
+private:
+    std::uint32_t next_byte() {
+        if (data_ < end_) {
+            return *data_++;
+        }
+        ++overrun_;
+        return 0;
+    }
+
+    const Byte* data_;
+    const Byte* end_;
+    std::uint32_t low_ = 0;
+    std::uint32_t range_ = 0xFFFFFFFFu;
+    std::uint32_t code_ = 0;
+    std::size_t overrun_ = 0;
+};
+
+// 自适应 order-0 字节模型：频率用 Fenwick 树维护，累计频率查询、符号查找与更新都是
+// O(log 256)。每编码一个符号其频率增加 kIncrement，总和超过 kMaxTotal 时全部减半。
+class AdaptiveByteModel {
+public:
+    static constexpr std::uint32_t kIncrement = 32;
+    static constexpr std::uint32_t kMaxTotal = RangeEncoder::kBottom;
+
+    AdaptiveByteModel();
+
+    void encode(RangeEncoder& encoder, Byte symbol);
+    Byte decode(RangeDecoder& decoder);
+
+private:
+    // 符号 symbol 之前所有符号的频率和
+    std::uint32_t cumulative(std::size_t symbol) const;
+    // 累计频率区间包含 target 的符号，cum 返回该符号的累计频率
+    std::size_t find(std::uint32_t target, std::uint32_t& cum) const;
+    void update(std::size_t symbol);
+    void rescale();
+
+    std::array<std::uint32_t, 256> freq_;
+    std::array<std::uint32_t, 257> tree_;  // Fenwick 树，下标从 1 开始
+    std::uint32_t total_ = 0;
+};
+
+// 字节序列的自适应 order-0 区间编码，可作为变换类算法（如 BWT+MTF）之后的熵编码阶段。
+// 编码结果不含长度，解码时由调用方给出符号数。
+void range_encode_bytes(std::vector<Byte>& output, const Byte* data, std::size_t size);
+std::vector<Byte> range_decode_bytes(const Byte* data, const Byte* end, std::size_t count);
+
+} // namespace compressup
@@ -0,0 +1,42 @@
+#include "range_compressor.h"
+
+#include "range_coder.h"
+#include "varint.h"
+
+namespace compressup {
+
+std::string RangeCompressor::name() const {
+    return "range";
+}
+
+std::unique_ptr<ICompressor> RangeCompressor::clone() const {
+    return std::make_unique<RangeCompressor>(*this);
+}
+
+std::vector<Byte> RangeCompressor::compress(std::string_view input) {
+    if (input.empty()) {
+        return {};
+    }
+
+    // 格式：[varint 原始长度][区间编码数据]
+    std::vector<Byte> output;
+    output.reserve(input.size() / 2 + 16);
+    write_varint(output, input.size());
+    range_encode_bytes(output, reinterpret_cast<const Byte*>(input.data()), input.size());
+    return output;
+}
+
+std::string RangeCompressor::decompress(const std::vector<Byte>& input) {
+    if (input.empty()) {
+        return {};
+    }
+
+    const Byte* data = input.data();
+    const Byte* end = data + input.size();
+    const std::uint64_t orig_len = read_varint(data, end);
+
+    auto decoded = range_decode_bytes(data, end, orig_len);
+    return std::string(decoded.begin(), decoded.end());
+}
+
+} // namespace compressup
@@ -0,0 +1,17 @@
+#pragma once
+
+#include "compressor.h"
+
+namespace compressup {
+
+// 自适应 order-0 区间编码（算术编码的整数实现）
+// 不需要传输码表，符号的编码长度可以是分数比特，偏斜分布上比 Huffman 更接近熵。
+class RangeCompressor : public ICompressor {
+public:
+    std::string name() const override;
+    std::unique_ptr<ICompressor> clone() const override;
+    std::vector<Byte> compress(std::string_view input) override;
+    std::string decompress(const std::vector<Byte>& input) override;
+};
+
+} // namespace compressup
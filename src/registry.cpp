@@ -2,10 +2,14 @@
 
 #include "bwt_compressor.h"
 #include "delta_compressor.h"
+#include "fse_compressor.h"
+#include "fse_order1_compressor.h"
 #include "huffman_compressor.h"
 #include "lz77_compressor.h"
+#include "lzh_compressor.h"
 #include "lzss_compressor.h"
 #include "lzw_compressor.h"
+#include "range_compressor.h"
 #include "rle_compressor.h"
 
 #include <stdexcept>
@@ -25,57 +29,128 @@ const std::vector<AlgorithmInfo> kAlgorithmInfos = {
     {"lzss", "LZSS - LZ77的优化变体", AlgorithmCategory::Dictionary, AlgorithmId::Lzss},
     {"delta", "Delta Encoding - 差分编码", AlgorithmCategory::Transform, AlgorithmId::Delta},
     {"bwt", "BWT+MTF - Burrows-Wheeler变换", AlgorithmCategory::Transform, AlgorithmId::Bwt},
+    {"lzh", "LZH - LZSS + Huffman 混合压缩 (类 Deflate)", AlgorithmCategory::Hybrid, AlgorithmId::Lzh},
+    {"range", "Range Coding - 自适应区间编码 (算术编码)", AlgorithmCategory::Entropy, AlgorithmId::Range},
+    {"fse", "FSE - 表驱动的 tANS 熵编码", AlgorithmCategory::Entropy, AlgorithmId::Fse},
+    {"fse-o1", "FSE-O1 - 以前一字节为上下文的 order-1 tANS 熵编码", AlgorithmCategory::Entropy, AlgorithmId::FseOrder1},
 };
 
 } // namespace
 
-std::unique_ptr<ICompressor> create_compressor(const std::string& name) {
+std::unique_ptr<ICompressor> create_compressor(const std::string& name, CompressionLevel level) {
     if (name == "rle") {
         return std::make_unique<RleCompressor>();
     }
     if (name == "lz77") {
-        return std::make_unique<Lz77Compressor>();
+        return std::make_unique<Lz77Compressor>(level);
     }
     if (name == "huffman") {
         return std::make_unique<HuffmanCompressor>();
     }
     if (name == "lzw") {
-        return std::make_unique<LzwCompressor>();
+        return std::make_unique<LzwCompressor>(level);
     }
     if (name == "lzss") {
-        return std::make_unique<LzssCompressor>();
+        return std::make_unique<LzssCompressor>(level);
     }
     if (name == "delta") {
         return std::make_unique<DeltaCompressor>();
     }
     if (name == "bwt") {
-        return std::make_unique<BwtCompressor>();
+        return std::make_unique<BwtCompressor>(level);
+    }
+    if (name == "lzh") {
+        return std::make_unique<LzhCompressor>(level);
+    }
+    if (name == "range") {
+        return std::make_unique<RangeCompressor>();
+    }
+    if (name == "fse") {
+        return std::make_unique<FseCompressor>();
+    }
+    if (name == "fse-o1") {
+        return std::make_unique<FseOrder1Compressor>();
     }
 
     throw std::invalid_argument("Unknown compressor: " + name);
 }
 
-std::unique_ptr<ICompressor> create_compressor(AlgorithmId id) {
+std::unique_ptr<ICompressor> create_compressor(AlgorithmId id, CompressionLevel level) {
     switch (id) {
     case AlgorithmId::Rle:
         return std::make_unique<RleCompressor>();
     case AlgorithmId::Lz77:
-        return std::make_unique<Lz77Compressor>();
+        return std::make_unique<Lz77Compressor>(level);
     case AlgorithmId::Huffman:
         return std::make_unique<HuffmanCompressor>();
     case AlgorithmId::Lzw:
-        return std::make_unique<LzwCompressor>();
+        return std::make_unique<LzwCompressor>(level);
     case AlgorithmId::Lzss:
-        return std::make_unique<LzssCompressor>();
+        return std::make_unique<LzssCompressor>(level);
     case AlgorithmId::Delta:
         return std::make_unique<DeltaCompressor>();
     case AlgorithmId::Bwt:
-        return std::make_unique<BwtCompressor>();
+        return std::make_unique<BwtCompressor>(level);
+    case AlgorithmId::Lzh:
+        return std::make_unique<LzhCompressor>(level);
+    case AlgorithmId::Range:
+        return std::make_unique<RangeCompressor>();
+    case AlgorithmId::Fse:
+        return std::make_unique<FseCompressor>();
+    case AlgorithmId::FseOrder1:
+        return std::make_unique<FseOrder1Compressor>();
     }
 
     throw std::invalid_argument("Unknown AlgorithmId");
 }
 
+std::unique_ptr<ICompressor> create_decompressor(AlgorithmId id, std::uint8_t format_version) {
+    switch (id) {
+    case AlgorithmId::Lz77:
+        // Legacy 与 Wide 流可由首字节区分，同一个解码器即可处理
+        if (format_version == static_cast<std::uint8_t>(Lz77Format::Legacy) ||
+            format_version == static_cast<std::uint8_t>(Lz77Format::Wide)) {
+            return std::make_unique<Lz77Compressor>();
+        }
+        break;
+    case AlgorithmId::Huffman:
+        // 两种流格式无法由内容区分，按容器记录的版本选择
+        if (format_version == static_cast<std::uint8_t>(HuffmanFormat::Tree) ||
+            format_version == static_cast<std::uint8_t>(HuffmanFormat::Canonical)) {
+            return std::make_unique<HuffmanCompressor>(static_cast<HuffmanFormat>(format_version));
+        }
+        break;
+    case AlgorithmId::Lzw:
+        // 12 位定长流与变长流无法由内容区分，按容器记录的版本选择
+        if (format_version == static_cast<std::uint8_t>(LzwFormat::Fixed) ||
+            format_version == static_cast<std::uint8_t>(LzwFormat::Variable)) {
+            return std::make_unique<LzwCompressor>(static_cast<LzwFormat>(format_version));
+        }
+        break;
+    case AlgorithmId::Bwt:
+        if (format_version >= static_cast<std::uint8_t>(BwtFormat::Mtf) &&
+            format_version <= static_cast<std::uint8_t>(BwtFormat::MultiCursor)) {
+            return std::make_unique<BwtCompressor>(CompressionLevel::Default,
+                                                   static_cast<BwtFormat>(format_version));
+        }
+        break;
+    case AlgorithmId::Lzh:
+        // 流首字节即格式标签，同一个解码器即可处理
+        if (format_version >= 1 && format_version <= LzhCompressor::kFormatTag) {
+            return std::make_unique<LzhCompressor>();
+        }
+        break;
+    default:
+        if (format_version == 1) {
+            return create_compressor(id);
+        }
+        break;
+    }
+
+    throw std::invalid_argument("Unsupported format version " + std::to_string(format_version) +
+                                " for algorithm " + algorithm_name_from_id(id));
+}
+
 AlgorithmId algorithm_id_from_name(const std::string& name) {
     if (name == "rle") return AlgorithmId::Rle;
     if (name == "lz77") return AlgorithmId::Lz77;
@@ -84,6 +159,10 @@ AlgorithmId algorithm_id_from_name(const std::string& name) {
     if (name == "lzss") return AlgorithmId::Lzss;
     if (name == "delta") return AlgorithmId::Delta;
     if (name == "bwt") return AlgorithmId::Bwt;
+    if (name == "lzh") return AlgorithmId::Lzh;
+    if (name == "range") return AlgorithmId::Range;
+    if (name == "fse") return AlgorithmId::Fse;
+    if (name == "fse-o1") return AlgorithmId::FseOrder1;
 
     throw std::invalid_argument("Unknown algorithm name: " + name);
 }
@@ -97,11 +176,43 @@ std::string algorithm_name_from_id(AlgorithmId id) {
     case AlgorithmId::Lzss: return "lzss";
     case AlgorithmId::Delta: return "delta";
     case AlgorithmId::Bwt: return "bwt";
+    case AlgorithmId::Lzh: return "lzh";
+    case AlgorithmId::Range: return "range";
+    case AlgorithmId::Fse: return "fse";
+    case AlgorithmId::FseOrder1: return "fse-o1";
     }
 
     throw std::invalid_argument("Unknown AlgorithmId");
 }
 
+CompressionLevel compression_level_from_string(const std::string& text) {
+    if (text == "fastest") return CompressionLevel::Fastest;
+    if (text == "fast") return CompressionLevel::Fast;
+    if (text == "default") return CompressionLevel::Default;
+    if (text == "better") return CompressionLevel::Better;
+    if (text == "best") return CompressionLevel::Best;
+
+    int value = 0;
+    try {
+        std::size_t consumed = 0;
+        value = std::stoi(text, &consumed);
+        if (consumed != text.size()) {
+            value = 0;
+        }
+    } catch (const std::exception&) {
+        value = 0;
+    }
+
+    if (value < 1 || value > 12) {
+        throw std::invalid_argument("Invalid compression level: " + text);
+    }
+    if (value >= static_cast<int>(CompressionLevel::Best)) return CompressionLevel::Best;
+    if (value >= static_cast<int>(CompressionLevel::Better)) return CompressionLevel::Better;
+    if (value >= static_cast<int>(CompressionLevel::Default)) return CompressionLevel::Default;
+    if (value >= static_cast<int>(CompressionLevel::Fast)) return CompressionLevel::Fast;
+    return CompressionLevel::Fastest;
+}
+
 std::vector<std::string> available_algorithms() {
     std::vector<std::string> result;
     result.reserve(kAlgorithmInfos.size());
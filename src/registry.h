@@ -19,6 +19,10 @@ enum class AlgorithmId : std::uint8_t {
     Lzss = 5,
     Delta = 6,
     Bwt = 7,
+    Lzh = 8,
+    Range = 9,
+    Fse = 10,
+    FseOrder1 = 11,
 };
 
 // 算法信息结构
@@ -29,14 +33,23 @@ struct AlgorithmInfo {
     AlgorithmId id;
 };
 
-// 工厂函数
-std::unique_ptr<ICompressor> create_compressor(const std::string& name);
-std::unique_ptr<ICompressor> create_compressor(AlgorithmId id);
+// 工厂函数：压缩级别由各算法映射为自己的搜索深度、窗口、解析策略或块大小，
+// 没有可调参数的算法忽略该级别
+std::unique_ptr<ICompressor> create_compressor(const std::string& name,
+                                               CompressionLevel level = CompressionLevel::Default);
+std::unique_ptr<ICompressor> create_compressor(AlgorithmId id,
+                                               CompressionLevel level = CompressionLevel::Default);
+
+// 创建能解码指定流格式版本的压缩器（版本号来自容器头），不支持的版本抛出异常
+std::unique_ptr<ICompressor> create_decompressor(AlgorithmId id, std::uint8_t format_version);
 
 // 名称和ID转换
 AlgorithmId algorithm_id_from_name(const std::string& name);
 std::string algorithm_name_from_id(AlgorithmId id);
 
+// 压缩级别解析：接受 fastest/fast/default/better/best 或数字 1-12（向下取到最近的级别）
+CompressionLevel compression_level_from_string(const std::string& text);
+
 // 查询所有可用算法
 std::vector<std::string> available_algorithms();
 std::vector<AlgorithmInfo> available_algorithm_infos();
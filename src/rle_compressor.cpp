@@ -8,6 +8,10 @@ std::string RleCompressor::name() const {
     return "rle";
 }
 
+std::unique_ptr<ICompressor> RleCompressor::clone() const {
+    return std::make_unique<RleCompressor>(*this);
+}
+
 std::vector<Byte> RleCompressor::compress(std::string_view input) {
     std::vector<Byte> out;
     if (input.empty()) {
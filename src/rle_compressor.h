@@ -7,6 +7,7 @@ namespace compressup {
 class RleCompressor : public ICompressor {
 public:
     std::string name() const override;
+    std::unique_ptr<ICompressor> clone() const override;
     std::vector<Byte> compress(std::string_view input) override;
     std::string decompress(const std::vector<Byte>& input) override;
 };
@@ -0,0 +1,246 @@
+#include "suffix_array.h"
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+
+namespace compressup {
+
+namespace {
+
+// 短输入直接比较后缀排序
+template <typename T>
+void sa_naive(const T* s, std::int32_t n, std::vector<std::int32_t>& sa) {
+    sa.resize(n);
+    std::iota(sa.begin(), sa.end(), 0);
+    std::sort(sa.begin(), sa.end(), [&](std::int32_t a, std::int32_t b) {
+        while (a < n && b < n) {
+            if (s[a] != s[b]) {
+                return s[a] < s[b];
+            }
+            ++a;
+            ++b;
+        }
+        return a == n;
+    });
+}
+
+// SA-IS：按 L/S 类型找出 LMS 子串，诱导排序得到其顺序后为 LMS 子串重新编号，
+// 递归求解缩减后的串，再由 LMS 后缀的正确顺序诱导出完整后缀数组。
+// s 的取值范围为 [0, upper]，结果写入 sa。
+template <typename T>
+void sa_is(const T* s, std::int32_t n, std::int32_t upper, std::vector<std::int32_t>& sa) {
+    if (n < 10) {
+        sa_naive(s, n, sa);
+        return;
+    }
+
+    sa.resize(n);
+    // is_s[i]：后缀 i 是否为 S 型（比后缀 i+1 小），最后一个后缀为 L 型
+    std::vector<std::uint8_t> is_s(n);
+    for (std::int32_t i = n - 2; i >= 0; --i) {
+        is_s[i] = s[i] == s[i + 1] ? is_s[i + 1] : (s[i] < s[i + 1]);
+    }
+
+    // 每个字符桶中 L 型在前、S 型在后：sum_l[c] 为桶 c 的起点，sum_s[c] 为其中 S 型部分的起点
+    std::vector<std::int32_t> sum_l(upper + 2), sum_s(upper + 2);
+    for (std::int32_t i = 0; i < n; ++i) {
+        if (!is_s[i]) {
+            ++sum_s[s[i]];
+        } else {
+            ++sum_l[s[i] + 1];
+        }
+    }
+    for (std::int32_t c = 0; c <= upper; ++c) {
+        sum_s[c] += sum_l[c];
+        if (c < upper) {
+            sum_l[c + 1] += sum_s[c];
+        }
+    }
+
+    std::vector<std::int32_t> bucket(upper + 1);
+    auto induce = [&](const std::vector<std::int32_t>& lms) {
+        std::fill(sa.begin(), sa.end(), -1);
+        std::copy(sum_s.begin(), sum_s.begin() + upper + 1, bucket.begin());
+        for (std::int32_t d : lms) {
+            sa[bucket[s[d]]++] = d;
+        }
+        std::copy(sum_l.begin(), sum_l.begin() + upper + 1, bucket.begin());
+        sa[bucket[s[n - 1]]++] = n - 1;
+        for (std::int32_t i = 0; i < n; ++i) {
+            const std::int32_t v = sa[i];
+            if (v >= 1 && !is_s[v - 1]) {
+                sa[bucket[s[v - 1]]++] = v - 1;
+            }
+        }
+        std::copy(sum_l.begin(), sum_l.begin() + upper + 1, bucket.begin());
+        for (std::int32_t i = n - 1; i >= 0; --i) {
+            const std::int32_t v = sa[i];
+            if (v >= 1 && is_s[v - 1]) {
+                sa[--bucket[s[v - 1] + 1]] = v - 1;
+            }
+        }
+    };
+
+    // LMS 位置：S 型且前一个为 L 型
+    std::vector<std::int32_t> lms_index(n, -1);
+    std::vector<std::int32_t> lms;
+    for (std::int32_t i = 1; i < n; ++i) {
+        if (!is_s[i - 1] && is_s[i]) {
+            lms_index[i] = static_cast<std::int32_t>(lms.size());
+            lms.push_back(i);
+        }
+    }
+    const auto m = static_cast<std::int32_t>(lms.size());
+
+    induce(lms);
+    if (m == 0) {
+        return;
+    }
+
+    std::vector<std::int32_t> sorted_lms;
+    sorted_lms.reserve(m);
+    for (std::int32_t v : sa) {
+        if (lms_index[v] != -1) {
+            sorted_lms.push_back(v);
+        }
+    }
+
+    // 相邻且内容相同的 LMS 子串取相同编号
+    std::vector<std::int32_t> reduced(m);
+    std::int32_t reduced_upper = 0;
+    reduced[lms_index[sorted_lms[0]]] = 0;
+    for (std::int32_t i = 1; i < m; ++i) {
+        std::int32_t l = sorted_lms[i - 1];
+        std::int32_t r = sorted_lms[i];
+        const std::int32_t end_l = lms_index[l] + 1 < m ? lms[lms_index[l] + 1] : n;
+        const std::int32_t end_r = lms_index[r] + 1 < m ? lms[lms_index[r] + 1] : n;
+        bool same = end_l - l == end_r - r;
+        if (same) {
+            while (l < end_l && s[l] == s[r]) {
+                ++l;
+                ++r;
+            }
+            same = l != n && s[l] == s[r];
+        }
+        if (!same) {
+            ++reduced_upper;
+        }
+        reduced[lms_index[sorted_lms[i]]] = reduced_upper;
+    }
+
+    // 递归前释放只在编号时使用的数组，降低峰值内存
+    std::vector<std::int32_t>().swap(lms_index);
+    std::vector<std::int32_t> reduced_sa;
+    sa_is(reduced.data(), m, reduced_upper, reduced_sa);
+    for (std::int32_t i = 0; i < m; ++i) {
+        sorted_lms[i] = lms[reduced_sa[i]];
+    }
+    induce(sorted_lms);
+}
+
+// 最小循环旋转的起始位置（双指针法，O(n)）
+std::size_t least_rotation(const Byte* text, std::size_t n) {
+    std::size_t i = 0;
+    std::size_t j = 1;
+    std::size_t k = 0;
+    while (i < n && j < n && k < n) {
+        const Byte a = text[(i + k) % n];
+        const Byte b = text[(j + k) % n];
+        if (a == b) {
+            ++k;
+            continue;
+        }
+        if (a > b) {
+            i += k + 1;
+        } else {
+            j += k + 1;
+        }
+        if (i == j) {
+            ++j;
+        }
+        k = 0;
+    }
+    return std::min(i, j);
+}
+
+// 最小周期：n 能被其整除时输入为 u^(n/p)，否则返回 n
+std::size_t primitive_period(const Byte* text, std::size_t n) {
+    std::vector<std::uint32_t> border(n + 1, 0);
+    for (std::uint32_t i = 1, k = 0; i < n; ++i) {
+        while (k > 0 && text[i] != text[k]) {
+            k = border[k];
+        }
+        if (text[i] == text[k]) {
+            ++k;
+        }
+        border[i + 1] = k;
+    }
+    const std::size_t period = n - border[n];
+    return n % period == 0 ? period : n;
+}
+
+} // namespace
+
+std::vector<std::int32_t> suffix_array(const Byte* text, std::size_t n) {
+    std::vector<std::int32_t> sa;
+    suffix_array(text, n, sa);
+    return sa;
+}
+
+void suffix_array(const Byte* text, std::size_t n, std::vector<std::int32_t>& sa) {
+    if (n > static_cast<std::size_t>(std::numeric_limits<std::int32_t>::max())) {
+        throw std::invalid_argument("suffix_array: input too large");
+    }
+    if (n == 0) {
+        sa.clear();
+        return;
+    }
+    sa_is(text, static_cast<std::int32_t>(n), 255, sa);
+}
+
+std::vector<std::int32_t> sort_rotations(const Byte* text, std::size_t n) {
+    std::vector<std::int32_t> rotations;
+    sort_rotations(text, n, rotations);
+    return rotations;
+}
+
+void sort_rotations(const Byte* text, std::size_t n, std::vector<std::int32_t>& rotations) {
+    if (n > static_cast<std::size_t>(std::numeric_limits<std::int32_t>::max())) {
+        throw std::invalid_argument("sort_rotations: input too large");
+    }
+    if (n == 0) {
+        rotations.clear();
+        return;
+    }
+
+    // u 为输入的本原根，旋转到最小旋转后为 Lyndon 串 w
+    const std::size_t period = primitive_period(text, n);
+    const std::size_t start = least_rotation(text, period);
+    std::vector<Byte> lyndon(period);
+    for (std::size_t i = 0; i < period; ++i) {
+        lyndon[i] = text[(start + i) % period];
+    }
+    if (period == n) {
+        // 非周期输入：原地把 w 中的位置换算为输入中的起始位置
+        suffix_array(lyndon.data(), period, rotations);
+        for (auto& q : rotations) {
+            q = static_cast<std::int32_t>((start + static_cast<std::size_t>(q)) % n);
+        }
+        return;
+    }
+
+    // w 的第 q 个旋转对应输入中起始位置 ≡ start + q (mod period) 的 n / period 个旋转
+    const auto order = suffix_array(lyndon.data(), period);
+    rotations.clear();
+    rotations.reserve(n);
+    for (std::int32_t q : order) {
+        const std::size_t first = (start + static_cast<std::size_t>(q)) % period;
+        for (std::size_t pos = first; pos < n; pos += period) {
+            rotations.push_back(static_cast<std::int32_t>(pos));
+        }
+    }
+}
+
+} // namespace compressup
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "types.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace compressup {
+
+// 后缀数组（SA-IS 算法，O(n) 时间）：返回值第 i 项为第 i 小的后缀的起始位置。
+// 一个后缀是另一个的前缀时较短者在前（相当于末尾有一个最小的哨兵字符）。
+std::vector<std::int32_t> suffix_array(const Byte* text, std::size_t n);
+// 同上，结果写入 sa，复用其已有容量
+void suffix_array(const Byte* text, std::size_t n, std::vector<std::int32_t>& sa);
+
+// 循环旋转排序：返回按字典序排列的所有循环旋转的起始位置，O(n) 时间。
+// 把输入旋转到最小旋转（Lyndon 串）后，后缀顺序与旋转顺序一致，因此只需对 n 个字节
+// 做一次后缀排序，不需要构造 2n 长的加倍串。输入为周期串 u^k 时对 u 排序后展开，
+// 相等的旋转按起始位置升序排列。
+std::vector<std::int32_t> sort_rotations(const Byte* text, std::size_t n);
+// 同上，结果写入 rotations，复用其已有容量
+void sort_rotations(const Byte* text, std::size_t n, std::vector<std::int32_t>& rotations);
+
+} // namespace compressup
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "types.h"
+
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+namespace compressup {
+
+// LEB128 变长整数：每字节低 7 位为数据，最高位为 1 表示后面还有字节
+
+inline void write_varint(std::vector<Byte>& output, std::uint64_t value) {
+    while (value >= 0x80) {
+        output.push_back(static_cast<Byte>(value | 0x80));
+        value >>= 7;
+    }
+    output.push_back(static_cast<Byte>(value));
+}
+
+inline std::uint64_t read_varint(const Byte*& data, const Byte* end) {
+    std::uint64_t value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (data >= end) {
+            throw std::runtime_error("Varint: unexpected end of data");
+        }
+        Byte b = *data++;
+        value |= static_cast<std::uint64_t>(b & 0x7F) << shift;
+        if ((b & 0x80) == 0) {
+            return value;
+        }
+    }
+    throw std::runtime_error("Varint: value too long");
+}
+
+} // namespace compressup
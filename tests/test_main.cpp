@@ -1,11 +1,30 @@
 #include "api.h"
+#include "bit_stream.h"
+#include "bwt_compressor.h"
 #include "compressor.h"
 #include "container.h"
 #include "file_io.h"
+#include "fse_coder.h"
+#include "fse_compressor.h"
+#include "fse_order1_compressor.h"
+#include "histogram.h"
+#include "huffman_compressor.h"
+#include "huffman_table.h"
+#include "lz77_compressor.h"
+#include "lz_copy.h"
+#include "lzss_compressor.h"
+#include "lzw_compressor.h"
+#include "match_length.h"
 #include "parallel_compressor.h"
+#include "range_coder.h"
+#include "range_compressor.h"
 #include "registry.h"
+#include "suffix_array.h"
+#include "varint.h"
 
+#include <algorithm>
 #include <iostream>
+#include <numeric>
 #include <filesystem>
 #include <random>
 #include <string>
@@ -118,6 +137,1324 @@ void test_parallel_compressor() {
     }
 }
 
+// 基线版本的 parallel_compress(text, algorithm, 32, 2) 输出（并行流版本 1，不记录内层流格式），
+// text 为 parallel_baseline_text()
+std::string parallel_baseline_text() {
+    std::string text;
+    for (int i = 0; i < 3; ++i) {
+        text += "abracadabra " + std::to_string(i * 7) + " tobeornottobe\n";
+    }
+    return text;
+}
+
+void check_parallel_baseline(const std::string& algo, const std::vector<Byte>& stream) {
+    bool ok = false;
+    try {
+        ok = parallel_decompress(stream, algo) == parallel_baseline_text();
+    } catch (const std::exception& e) {
+        std::cout << "  [ERROR] " << algo << ": " << e.what() << "\n";
+    }
+    std::cout << "  [" << (ok ? "PASS" : "FAIL") << "] baseline parallel " << algo << " stream\n";
+    ok ? ++g_passed : ++g_failed;
+}
+
+void test_parallel_baseline_streams() {
+    std::cout << "\n=== Parallel Baseline Stream Test ===\n";
+
+    // Huffman 默认格式已改为 Canonical，版本 1 的并行流须按格式 1（Tree）解码
+    const std::vector<Byte> huffman = {
+        0xC4, 0x01, 0x55, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00, 0x20, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x45, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x20, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x23, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x6E,
+        0x00, 0x01, 0x0A, 0x01, 0x30, 0x01, 0x6F, 0x01, 0x61, 0x00, 0x00, 0x01, 0x72, 0x00, 0x00, 0x01,
+        0x64, 0x01, 0x63, 0x01, 0x20, 0x00, 0x00, 0x01, 0x65, 0x01, 0x74, 0x01, 0x62, 0x69, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x7C, 0x6A, 0xD1, 0xF1, 0xB1, 0xDE, 0x9F, 0x86, 0x01, 0xDD, 0x3F,
+        0x04, 0xF8, 0x80, 0x20, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x45, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x20, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x23, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x01, 0x6E, 0x01, 0x64, 0x01, 0x6F, 0x01, 0x61, 0x00, 0x00, 0x00, 0x01, 0x63,
+        0x01, 0x20, 0x00, 0x00, 0x01, 0x0A, 0x01, 0x37, 0x01, 0x65, 0x00, 0x01, 0x62, 0x00, 0x01, 0x74,
+        0x01, 0x72, 0x6C, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x84, 0x5D, 0xEC, 0xD6, 0x78, 0xEB,
+        0x3E, 0x07, 0xB8, 0xEB, 0xA3, 0xBD, 0x84, 0x50, 0x15, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x3D, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x15, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x20, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x34, 0x01, 0x61, 0x00, 0x01, 0x0A, 0x01,
+        0x31, 0x01, 0x6F, 0x00, 0x00, 0x01, 0x74, 0x01, 0x62, 0x00, 0x00, 0x01, 0x6E, 0x01, 0x65, 0x00,
+        0x01, 0x72, 0x01, 0x20, 0x46, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xBC, 0x3E, 0x61, 0xF1,
+        0xBA, 0xF6, 0x32, 0x37, 0x48,
+    };
+    check_parallel_baseline("huffman", huffman);
+
+    // LZW 默认格式已改为 Variable，版本 1 的并行流须按 12 位定长格式解码
+    const std::vector<Byte> lzw = {
+        0xC4, 0x01, 0x55, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00, 0x20, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x2F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x20, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x06, 0x10, 0x62, 0x07, 0x20, 0x61, 0x06, 0x30, 0x61, 0x06,
+        0x41, 0x00, 0x10, 0x20, 0x20, 0x03, 0x00, 0x20, 0x07, 0x40, 0x6F, 0x06, 0x20, 0x65, 0x06, 0xF0,
+        0x72, 0x06, 0xE0, 0x6F, 0x07, 0x41, 0x0C, 0x10, 0xE0, 0x0A, 0x10, 0x70, 0x61, 0x20, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x2F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x20, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x06, 0x30, 0x61, 0x06, 0x40, 0x61, 0x06, 0x20, 0x72, 0x06, 0x10,
+        0x20, 0x03, 0x70, 0x20, 0x07, 0x40, 0x6F, 0x06, 0x20, 0x65, 0x06, 0xF0, 0x72, 0x06, 0xE0, 0x6F,
+        0x07, 0x41, 0x0A, 0x10, 0xC0, 0x0A, 0x10, 0x31, 0x05, 0x10, 0x01, 0x02, 0x15, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x25, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x15, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x06, 0x20, 0x72, 0x06, 0x10, 0x20, 0x03, 0x10, 0x34, 0x02, 0x00, 0x74,
+        0x06, 0xF0, 0x62, 0x06, 0x50, 0x6F, 0x07, 0x20, 0x6E, 0x06, 0xF0, 0x74, 0x10, 0x71, 0x09, 0x00,
+        0xA0,
+    };
+    check_parallel_baseline("lzw", lzw);
+
+    // BWT 默认格式已不是 Mtf，版本 1 的并行流须按格式 1 解码
+    const std::vector<Byte> bwt = {
+        0xC4, 0x01, 0x55, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00, 0x20, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x38, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x20, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x20, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x65, 0x62, 0x32, 0x23, 0x72, 0x00, 0x66, 0x10, 0x05, 0x03,
+        0x66, 0x70, 0x00, 0x03, 0x00, 0x00, 0x00, 0x00, 0x67, 0x00, 0x04, 0x74, 0x00, 0x0A, 0x71, 0x04,
+        0x00, 0x00, 0x06, 0x04, 0x0A, 0x02, 0x20, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x38, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x20, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x0F, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x20, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x65, 0x62,
+        0x39, 0x23, 0x72, 0x66, 0x10, 0x01, 0x02, 0x66, 0x00, 0x70, 0x00, 0x07, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x67, 0x00, 0x04, 0x74, 0x00, 0x0A, 0x71, 0x04, 0x00, 0x06, 0x04, 0x0A, 0x02, 0x15, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x2D, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x15, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x15, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x65, 0x62, 0x36, 0x23, 0x34, 0x72, 0x70, 0x00, 0x11, 0x65,
+        0x00, 0x03, 0x74, 0x00, 0x09, 0x71, 0x04, 0x06, 0x04, 0x08, 0x02,
+    };
+    check_parallel_baseline("bwt", bwt);
+
+    // 当前的并行流在头中记录内层流格式版本
+    for (const std::string algo : {"huffman", "lzw", "bwt", "lz77"}) {
+        const std::string text = parallel_baseline_text();
+        const auto stream = parallel_compress(text, algo, 32, 2);
+        const bool ok = stream.size() > 2 && stream[1] == 0x02 &&
+                        stream[2] == create_compressor(algo)->format_version() &&
+                        parallel_decompress(stream, algo) == text;
+        std::cout << "  [" << (ok ? "PASS" : "FAIL") << "] parallel " << algo << " records format version\n";
+        ok ? ++g_passed : ++g_failed;
+    }
+
+    // 非默认格式的内层压缩器：各块按其格式编码，解码端按头中的版本选择解码器
+    const std::string text = parallel_baseline_text();
+    ParallelCompressor tree(std::make_unique<HuffmanCompressor>(HuffmanFormat::Tree), 32, 2);
+    const auto tree_stream = tree.compress(text);
+    bool ok = tree_stream[2] == static_cast<Byte>(HuffmanFormat::Tree) &&
+              parallel_decompress(tree_stream, "huffman") == text;
+    std::cout << "  [" << (ok ? "PASS" : "FAIL") << "] parallel huffman tree format\n";
+    ok ? ++g_passed : ++g_failed;
+
+    // BWT 的 5 种流格式都经并行流往返
+    ok = true;
+    for (BwtFormat format : {BwtFormat::Mtf, BwtFormat::MtfRange, BwtFormat::MtfHuffman, BwtFormat::LargeBlock,
+                             BwtFormat::MultiCursor}) {
+        ParallelCompressor parallel(std::make_unique<BwtCompressor>(CompressionLevel::Default, format), 32, 2);
+        const auto stream = parallel.compress(text);
+        ok = ok && stream[2] == static_cast<Byte>(format) && parallel_decompress(stream, "bwt") == text;
+    }
+    std::cout << "  [" << (ok ? "PASS" : "FAIL") << "] parallel bwt formats 1-5\n";
+    ok ? ++g_passed : ++g_failed;
+}
+
+// 原始的窗口穷举 LZ77 编码，作为哈希链查找器的参照
+std::vector<Byte> reference_lz77_compress(std::string_view input) {
+    std::vector<Byte> out;
+    const std::size_t n = input.size();
+    std::size_t pos = 0;
+    while (pos < n) {
+        std::size_t best_len = 0;
+        std::size_t best_offset = 0;
+        std::size_t start = pos > Lz77Compressor::kWindowSize ? pos - Lz77Compressor::kWindowSize : 0;
+        for (std::size_t c = start; c < pos; ++c) {
+            std::size_t len = 0;
+            while (len < Lz77Compressor::kMaxMatchLength && pos + len < n &&
+                   input[c + len] == input[pos + len]) {
+                ++len;
+            }
+            if (len > best_len && len >= 3) {
+                best_len = len;
+                best_offset = pos - c;
+                if (best_len == Lz77Compressor::kMaxMatchLength) break;
+            }
+        }
+        if (best_len >= 3) {
+            out.push_back(static_cast<Byte>(best_len));
+            out.push_back(static_cast<Byte>(best_offset >> 8));
+            out.push_back(static_cast<Byte>(best_offset & 0xFF));
+            pos += best_len;
+        } else {
+            out.push_back(0x80);
+            out.push_back(static_cast<Byte>(input[pos]));
+            ++pos;
+        }
+    }
+    return out;
+}
+
+void test_lz77_chain_depth() {
+    std::cout << "\n=== LZ77 Chain Depth Test ===\n";
+
+    std::string text;
+    for (int i = 0; i < 200; ++i) {
+        text += "ts=" + std::to_string(1700000000 + i * 7) + " level=info msg=\"request done\" ";
+        text += generate_random_string(8, static_cast<unsigned>(i));
+    }
+
+    const std::vector<std::size_t> depths = {1, 4, 16, Lz77Compressor::kMaxChainDepth};
+    for (std::size_t depth : depths) {
+        std::string label = "lz77_depth_" + std::to_string(depth);
+        try {
+            Lz77Options options;
+            options.format = Lz77Format::Legacy;
+            options.max_chain_depth = depth;
+            Lz77Compressor compressor(options);
+            auto compressed = compressor.compress(text);
+            bool ok = compressor.decompress(compressed) == text;
+            if (depth == Lz77Compressor::kMaxChainDepth) {
+                ok = ok && compressed == reference_lz77_compress(text);
+            }
+
+            std::cout << "  [" << (ok ? "PASS" : "FAIL") << "] " << label
+                      << " size=" << compressed.size() << "\n";
+            ok ? ++g_passed : ++g_failed;
+        } catch (const std::exception& e) {
+            std::cout << "  [ERROR] " << label << ": " << e.what() << "\n";
+            ++g_failed;
+        }
+    }
+}
+
+void test_lz77_wide_format() {
+    std::cout << "\n=== LZ77 Wide Format Test ===\n";
+
+    std::string json;
+    for (int i = 0; i < 2000; ++i) {
+        json += "{\"id\":" + std::to_string(i) + ",\"service\":\"gateway\",\"status\":200,"
+                "\"path\":\"/api/v1/items\",\"latency_ms\":" + std::to_string(i % 97) + "}\n";
+    }
+
+    Lz77Options legacy_options;
+    legacy_options.format = Lz77Format::Legacy;
+    const auto legacy_stream = Lz77Compressor(legacy_options).compress(json);
+
+    for (std::size_t window : {Lz77Compressor::kMinWideWindow, std::size_t{1} << 16,
+                               Lz77Compressor::kMaxWideWindow}) {
+        std::string label = "lz77_wide_window_" + std::to_string(window);
+        try {
+            Lz77Options options;
+            options.window_size = window;
+            Lz77Compressor compressor(options);
+            auto compressed = compressor.compress(json);
+
+            bool ok = compressor.decompress(compressed) == json &&
+                      compressed.size() < legacy_stream.size();
+            std::cout << "  [" << (ok ? "PASS" : "FAIL") << "] " << label
+                      << " size=" << compressed.size()
+                      << " legacy=" << legacy_stream.size() << "\n";
+            ok ? ++g_passed : ++g_failed;
+        } catch (const std::exception& e) {
+            std::cout << "  [ERROR] " << label << ": " << e.what() << "\n";
+            ++g_failed;
+        }
+    }
+
+    // 默认（Wide）解码器仍能解开 Legacy 流
+    bool legacy_ok = Lz77Compressor().decompress(legacy_stream) == json;
+    std::cout << "  [" << (legacy_ok ? "PASS" : "FAIL") << "] lz77_legacy_decode\n";
+    legacy_ok ? ++g_passed : ++g_failed;
+
+    // 流头声称的原始长度（约 32 GiB）远超载荷：应按流截断报错，而不是先分配整段输出
+    std::vector<Byte> forged = {static_cast<Byte>(Lz77Format::Wide)};
+    write_varint(forged, std::uint64_t{1} << 35);
+    forged.insert(forged.end(), {0x30, 'a', 'b', 'c'});
+    bool forged_ok = false;
+    try {
+        Lz77Compressor().decompress(forged);
+    } catch (const std::runtime_error& e) {
+        forged_ok = std::string(e.what()).find("unexpected end") != std::string::npos;
+    } catch (const std::exception&) {
+    }
+    std::cout << "  [" << (forged_ok ? "PASS" : "FAIL") << "] lz77_wide_forged_length\n";
+    forged_ok ? ++g_passed : ++g_failed;
+}
+
+void test_lzss_levels() {
+    std::cout << "\n=== LZSS Level Test ===\n";
+
+    std::string text;
+    for (int i = 0; i < 300; ++i) {
+        text += "GET /static/img/" + std::to_string(i % 17) + ".png HTTP/1.1 200 ";
+        text += generate_random_string(6, static_cast<unsigned>(i)) + "\n";
+    }
+    text += std::string(3000, 'z');
+
+    const std::vector<std::pair<std::string, CompressionLevel>> levels = {
+        {"fastest", CompressionLevel::Fastest},
+        {"fast", CompressionLevel::Fast},
+        {"default", CompressionLevel::Default},
+        {"better", CompressionLevel::Better},
+        {"best", CompressionLevel::Best},
+    };
+
+    for (const auto& [level_name, level] : levels) {
+        std::string label = "lzss_" + level_name;
+        try {
+            LzssCompressor compressor(level);
+            auto compressed = compressor.compress(text);
+            // 解码不依赖压缩级别
+            bool ok = LzssCompressor().decompress(compressed) == text;
+
+            std::cout << "  [" << (ok ? "PASS" : "FAIL") << "] " << label
+                      << " size=" << compressed.size() << "\n";
+            ok ? ++g_passed : ++g_failed;
+        } catch (const std::exception& e) {
+            std::cout << "  [ERROR] " << label << ": " << e.what() << "\n";
+            ++g_failed;
+        }
+    }
+}
+
+void test_lzss_parse_strategies() {
+    std::cout << "\n=== LZSS Parse Strategy Test ===\n";
+
+    // 重复度高、短语相互重叠的语料：贪心取到的最长匹配常会挡住下一个位置更长的匹配
+    std::string text;
+    std::mt19937 rng(11);
+    const std::vector<std::string> words = {"abc", "abcd", "bcde", "cdefg", "defgh", "abcdefgh", "efghij", "ghij"};
+    while (text.size() < 60000) {
+        text += words[rng() % words.size()];
+        text += words[rng() % words.size()];
+        text += static_cast<char>('0' + rng() % 4);
+    }
+
+    // 同一解码器：最优解析 (Best) ≤ 惰性匹配 (Better) ≤ 贪心 (Default)
+    const auto greedy = LzssCompressor(CompressionLevel::Default).compress(text);
+    const auto lazy = LzssCompressor(CompressionLevel::Better).compress(text);
+    const auto optimal = LzssCompressor(CompressionLevel::Best).compress(text);
+    LzssCompressor decoder;
+    bool ok = optimal.size() <= lazy.size() && lazy.size() <= greedy.size() &&
+              decoder.decompress(greedy) == text && decoder.decompress(lazy) == text &&
+              decoder.decompress(optimal) == text;
+    std::cout << "  [" << (ok ? "PASS" : "FAIL") << "] greedy " << greedy.size() << " bytes, lazy "
+              << lazy.size() << " bytes, optimal " << optimal.size() << " bytes\n";
+    ok ? ++g_passed : ++g_failed;
+}
+
+void test_lzw_format() {
+    std::cout << "\n=== LZW Format Test ===\n";
+
+    // 12 位格式的字节序列保持不变：[8 字节原始长度][每个编码 12 位，高位在前]
+    const std::vector<Byte> expected = {
+        0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x05, 0x40, 0x4F, 0x04, 0x20, 0x45, 0x04, 0xF0,
+        0x52, 0x04, 0xE0, 0x4F, 0x05, 0x41, 0x00, 0x10, 0x21, 0x04, 0x10, 0x91, 0x03, 0x10, 0x51, 0x07,
+    };
+    LzwCompressor lzw(LzwFormat::Fixed);
+    bool ok = lzw.compress("TOBEORNOTTOBEORTOBEORNOT") == expected;
+    std::cout << "  [" << (ok ? "PASS" : "FAIL") << "] classic TOBEORNOT stream\n";
+    ok ? ++g_passed : ++g_failed;
+
+    // 字典填满（4096 项）之后仍按已有条目匹配
+    std::string text;
+    while (text.size() < 200000) {
+        text += generate_random_string(64, static_cast<unsigned>(text.size() % 7)) + std::to_string(text.size());
+    }
+    ok = lzw.decompress(lzw.compress(text)) == text;
+    std::cout << "  [" << (ok ? "PASS" : "FAIL") << "] full dictionary roundtrip\n";
+    ok ? ++g_passed : ++g_failed;
+
+    // 变长格式：编码位宽从 9 位起步，短输入与长文本都比 12 位定长格式小
+    LzwCompressor variable;
+    auto fixed_data = lzw.compress(text);
+    auto variable_data = variable.compress(text);
+    ok = variable.format_version() == 2 && variable_data.size() < fixed_data.size() &&
+         variable.decompress(variable_data) == text &&
+         variable.compress("TOBEORNOTTOBEORTOBEORNOT").size() < expected.size() &&
+         create_decompressor(AlgorithmId::Lzw, 1)->decompress(fixed_data) == text;
+    std::cout << "  [" << (ok ? "PASS" : "FAIL") << "] variable width: " << variable_data.size()
+              << " bytes vs fixed " << fixed_data.size() << " bytes\n";
+    ok ? ++g_passed : ++g_failed;
+
+    // 内容漂移：前半段填满字典后换成另一组词汇，压缩率下降触发 CLEAR，后半段接近单独压缩的大小
+    auto word_text = [](const std::vector<std::string>& words, unsigned seed) {
+        std::mt19937 rng(seed);
+        std::string out;
+        while (out.size() < 600000) {
+            out += words[rng() % words.size()] + std::to_string(rng() % 1000) + " ";
+        }
+        return out;
+    };
+    const std::string first = word_text({"alpha", "beta", "gamma", "delta", "epsilon"}, 1);
+    const std::string second = word_text({"<node id=", "/>", "<edge from=", "weight=\"", "\">"}, 2);
+    const std::string drift = first + second;
+    auto drift_data = variable.compress(drift);
+    const std::size_t separate = variable.compress(first).size() + variable.compress(second).size();
+    ok = variable.decompress(drift_data) == drift && drift_data.size() * 10 <= separate * 11;
+    std::cout << "  [" << (ok ? "PASS" : "FAIL") << "] dictionary reset on drift: " << drift_data.size()
+              << " bytes vs " << separate << " bytes compressed separately\n";
+    ok ? ++g_passed : ++g_failed;
+
+    // 压缩级别：级别越高检查越频繁、阈值越高；只影响编码端，默认解码器即可还原
+    ok = true;
+    std::size_t previous_interval = ~std::size_t{0};
+    double previous_threshold = 0.0;
+    for (CompressionLevel level : {CompressionLevel::Fastest, CompressionLevel::Fast, CompressionLevel::Default,
+                                   CompressionLevel::Better, CompressionLevel::Best}) {
+        LzwCompressor leveled(level);
+        ok = ok && leveled.format_version() == 2 && leveled.reset_check_interval() <= previous_interval &&
+             leveled.reset_threshold() >= previous_threshold &&
+             variable.decompress(leveled.compress(drift)) == drift;
+        previous_interval = leveled.reset_check_interval();
+        previous_threshold = leveled.reset_threshold();
+    }
+    ok = ok && LzwCompressor(CompressionLevel::Default).compress(drift) == drift_data;
+    std::cout << "  [" << (ok ? "PASS" : "FAIL") << "] reset monitor follows compression level\n";
+    ok ? ++g_passed : ++g_failed;
+
+    // 随机数据：字典在 65536 项处冻结，位宽保持 16 位
+    const std::string binary = generate_binary_data(400000);
+    ok = variable.decompress(variable.compress(binary)) == binary;
+    std::cout << "  [" << (ok ? "PASS" : "FAIL") << "] variable width frozen dictionary\n";
+    ok ? ++g_passed : ++g_failed;
+
+    // 解码器从输出的更早位置复制条目：长游程反复出现 cScSc（编码即正在建立的条目），复制源与目标重叠
+    const std::string runs = std::string(100000, 'a') + "ab" + std::string(3000, 'b') + std::string(17, 'a');
+    ok = lzw.decompress(lzw.compress(runs)) == runs && variable.decompress(variable.compress(runs)) == runs;
+    std::cout << "  [" << (ok ? "PASS" : "FAIL") << "] overlapping cScSc copies\n";
+    ok ? ++g_passed : ++g_failed;
+
+    // 引用尚未建立的条目、或截断的流必须报错
+    int rejected = 0;
+    std::vector<std::vector<Byte>> corrupt = {
+        {0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x04, 0x1F, 0xFF, 0x00},  // 第二个编码 4095
+        {0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x04, 0x1F},              // 截断
+    };
+    for (const auto& data : corrupt) {
+        try {
+            lzw.decompress(data);
+        } catch (const std::exception&) {
+            ++rejected;
+        }
+    }
+    auto truncated = variable.compress(text);
+    truncated.resize(truncated.size() / 2);
+    try {
+        variable.decompress(truncated);
+    } catch (const std::exception&) {
+        ++rejected;
+    }
+    ok = rejected == 3;
+    std::cout << "  [" << (ok ? "PASS" : "FAIL") << "] invalid lzw streams rejected\n";
+    ok ? ++g_passed : ++g_failed;
+
+    // 流头声称的原始长度（1 TiB）远超几个编码所能解出的长度：分配输出之前就应拒绝
+    std::vector<Byte> forged_fixed(8, 0);
+    forged_fixed[5] = 0x01;
+    forged_fixed.insert(forged_fixed.end(), {0x04, 0x10, 0x42, 0x04, 0x30, 0x44});
+    std::vector<Byte> forged_variable;
+    write_varint(forged_variable, std::uint64_t{1} << 40);
+    forged_variable.insert(forged_variable.end(), {0x41, 0x21, 0x10, 0x00});
+    rejected = 0;
+    for (const auto& [decoder, data] : {std::pair{&lzw, &forged_fixed}, std::pair{&variable, &forged_variable}}) {
+        try {
+            decoder->decompress(*data);
+        } catch (const std::runtime_error& e) {
+            rejected += std::string(e.what()).find("exceeds payload") != std::string::npos;
+        } catch (const std::exception&) {
+        }
+    }
+    ok = rejected == 2;
+    std::cout << "  [" << (ok ? "PASS" : "FAIL") << "] forged lzw original length rejected\n";
+    ok ? ++g_passed : ++g_failed;
+}
+
+void test_lzh_hybrid() {
+    std::cout << "\n=== LZH Hybrid Test ===\n";
+
+    // 重复的日志行：既有长距离重复，也有偏斜的字节分布
+    std::string text;
+    for (int i = 0; i < 2000; ++i) {
+        text += "2026-10-16 12:" + std::to_string(10 + i % 50) + " INFO request id=" +
+                std::to_string(i * 7919 % 100000) + " path=/api/v1/items/" +
+                std::to_string(i % 97) + " status=200\n";
+    }
+
+    try {
+        auto lzh = create_compressor("lzh")->compress(text);
+        auto lzss = create_compressor("lzss")->compress(text);
+        auto huffman = create_compressor("huffman")->compress(text);
+
+        bool ok = create_compressor("lzh")->decompress(lzh) == text &&
+                  lzh.size() < lzss.size() && lzh.size() < huffman.size();
+        std::cout << "  [" << (ok ? "PASS" : "FAIL") << "] lzh size=" << lzh.size()
+                  << " lzss=" << lzss.size() << " huffman=" << huffman.size() << "\n";
+        ok ? ++g_passed : ++g_failed;
+    } catch (const std::exception& e) {
+        std::cout << "  [ERROR] lzh: " << e.what() << "\n";
+        ++g_failed;
+    }
+
+    // 长匹配（超过 LZSS 的 18 字节上限）与单一字节的流
+    check_roundtrip("lzh", "long matches", generate_random_string(5000, 3) + generate_random_string(5000, 3));
+    check_roundtrip("lzh", "single byte", std::string(70000, 'q'));
+}
+
+void test_compression_levels() {
+    std::cout << "\n=== Compression Level Test ===\n";
+
+    std::string text;
+    for (int i = 0; i < 400; ++i) {
+        text += "user=" + std::to_string(i % 23) + " action=login result=ok ";
+        text += generate_random_string(5, static_cast<unsigned>(i)) + "\n";
+    }
+
+    const std::vector<CompressionLevel> levels = {
+        CompressionLevel::Fastest, CompressionLevel::Fast, CompressionLevel::Default,
+        CompressionLevel::Better, CompressionLevel::Best,
+    };
+
+    for (const auto& algo : available_algorithms()) {
+        int algo_passed = 0;
+        for (CompressionLevel level : levels) {
+            try {
+                auto compressed = create_compressor(algo, level)->compress(text);
+                // 解码端不需要知道压缩级别
+                if (create_compressor(algo)->decompress(compressed) == text) {
+                    ++algo_passed;
+                    ++g_passed;
+                    continue;
+                }
+                std::cerr << "[FAIL] algo=" << algo << " level=" << static_cast<int>(level) << "\n";
+            } catch (const std::exception& e) {
+                std::cerr << "[ERROR] algo=" << algo << " level=" << static_cast<int>(level)
+                          << " exception: " << e.what() << "\n";
+            }
+            ++g_failed;
+        }
+        std::cout << "  " << algo << ": " << algo_passed << "/" << levels.size() << " passed\n";
+    }
+
+    bool parse_ok = compression_level_from_string("best") == CompressionLevel::Best &&
+                    compression_level_from_string("1") == CompressionLevel::Fastest &&
+                    compression_level_from_string("7") == CompressionLevel::Default &&
+                    compression_level_from_string("12") == CompressionLevel::Best;
+    try {
+        compression_level_from_string("13");
+        parse_ok = false;
+    } catch (const std::invalid_argument&) {
+    }
+    std::cout << "  [" << (parse_ok ? "PASS" : "FAIL") << "] level_parse\n";
+    parse_ok ? ++g_passed : ++g_failed;
+
+    // 并行包装器的各块沿用内层压缩器的级别：每块与该级别单独压缩的结果相同
+    constexpr std::size_t kChunk = 4096;
+    for (const std::string algo : {"lz77", "lzss", "lzw", "lzh", "bwt"}) {
+        bool ok = true;
+        for (CompressionLevel level : {CompressionLevel::Fastest, CompressionLevel::Best}) {
+            const auto stream = parallel_compress(text, algo, kChunk, 2, level);
+            std::size_t expected = 15;
+            for (std::size_t pos = 0; pos < text.size(); pos += kChunk) {
+                expected += 16 + create_compressor(algo, level)->compress(std::string_view(text).substr(pos, kChunk)).size();
+            }
+            ok = ok && stream.size() == expected && parallel_decompress(stream, algo) == text;
+        }
+        std::cout << "  [" << (ok ? "PASS" : "FAIL") << "] parallel_" << algo << " keeps level\n";
+        ok ? ++g_passed : ++g_failed;
+    }
+}
+
+void test_match_length() {
+    std::cout << "\n=== Match Length Kernel Test (" << match_length_kernel() << ") ===\n";
+
+    std::string base = generate_random_string(200, 7);
+    bool ok = true;
+    // 在每个位置制造一次失配，并覆盖各种 limit，与逐字节比较的结果对照
+    for (std::size_t diff_pos = 0; diff_pos <= 130 && ok; ++diff_pos) {
+        std::string other = base;
+        if (diff_pos < other.size()) {
+            other[diff_pos] = static_cast<char>(other[diff_pos] ^ 0x20);
+        }
+        for (std::size_t limit = 0; limit <= 140; ++limit) {
+            std::size_t expected = 0;
+            while (expected < limit && base[expected] == other[expected]) {
+                ++expected;
+            }
+            std::size_t actual = match_length(reinterpret_cast<const Byte*>(base.data()),
+                                              reinterpret_cast<const Byte*>(other.data()), limit);
+            if (actual != expected) {
+                std::cerr << "[FAIL] match_length diff_pos=" << diff_pos << " limit=" << limit
+                          << " expected=" << expected << " actual=" << actual << "\n";
+                ok = false;
+                break;
+            }
+        }
+    }
+
+    std::cout << "  [" << (ok ? "PASS" : "FAIL") << "] match_length\n";
+    ok ? ++g_passed : ++g_failed;
+}
+
+void test_lz_overlap_copy() {
+    std::cout << "\n=== LZ Overlapping Match Copy Test ===\n";
+
+    bool ok = true;
+    // copy_match 与逐字节复制对照，覆盖 1..40 的偏移和不同长度
+    for (std::size_t offset = 1; offset <= 40 && ok; ++offset) {
+        for (std::size_t length = 1; length <= 100; ++length) {
+            std::vector<Byte> expected(offset + length + kWildCopyOverrun, 0);
+            for (std::size_t i = 0; i < offset; ++i) {
+                expected[i] = static_cast<Byte>('a' + i % 26);
+            }
+            std::vector<Byte> actual = expected;
+            copy_match_exact(expected.data() + offset, offset, length);
+            copy_match(actual.data() + offset, offset, length);
+            if (!std::equal(expected.begin(), expected.begin() + offset + length, actual.begin())) {
+                std::cerr << "[FAIL] copy_match offset=" << offset << " length=" << length << "\n";
+                ok = false;
+                break;
+            }
+        }
+    }
+    std::cout << "  [" << (ok ? "PASS" : "FAIL") << "] copy_match\n";
+    ok ? ++g_passed : ++g_failed;
+
+    // 各种短周期重复数据会产生大量重叠匹配，经解码快速路径往返
+    std::string periodic;
+    for (std::size_t period = 1; period <= 17; ++period) {
+        std::string unit = generate_random_string(period, static_cast<unsigned>(period));
+        for (std::size_t i = 0; i < 2000 / period + 3; ++i) {
+            periodic += unit;
+        }
+        periodic += generate_random_string(5, static_cast<unsigned>(100 + period));
+    }
+    for (const char* algo : {"lz77", "lzss"}) {
+        check_roundtrip(algo, "periodic runs", periodic);
+        check_roundtrip(algo, "long run", std::string(100000, 'z'));
+    }
+
+    Lz77Options legacy;
+    legacy.format = Lz77Format::Legacy;
+    legacy.max_chain_depth = 16;
+    Lz77Compressor legacy_lz77(legacy);
+    bool legacy_ok = legacy_lz77.decompress(legacy_lz77.compress(periodic)) == periodic;
+    std::cout << "  [" << (legacy_ok ? "PASS" : "FAIL") << "] lz77 legacy periodic runs\n";
+    legacy_ok ? ++g_passed : ++g_failed;
+
+    // LZSS 流头声称 1 TiB 原始长度、载荷只有一个字面量：分配输出之前就应拒绝
+    std::vector<Byte> forged(8, 0);
+    forged[5] = 0x01;
+    forged.insert(forged.end(), {0x01, 0x00, 0x00, 0x00, 0x00, 'a'});
+    bool forged_ok = false;
+    try {
+        LzssCompressor().decompress(forged);
+    } catch (const std::runtime_error& e) {
+        forged_ok = std::string(e.what()).find("exceeds payload") != std::string::npos;
+    } catch (const std::exception&) {
+    }
+    std::cout << "  [" << (forged_ok ? "PASS" : "FAIL") << "] lzss forged original length\n";
+    forged_ok ? ++g_passed : ++g_failed;
+}
+
+void test_histogram() {
+    std::cout << "\n=== Histogram Test ===\n";
+
+    auto naive = [](std::string_view input) {
+        ByteHistogram counts{};
+        for (unsigned char c : input) {
+            ++counts[c];
+        }
+        return counts;
+    };
+
+    bool ok = true;
+    const std::string binary = generate_binary_data(100003, 9);
+    for (std::size_t size : {0, 1, 15, 16, 17, 33, 1000, 100003}) {
+        ok = ok && byte_histogram(std::string_view(binary).substr(0, size)) ==
+                       naive(std::string_view(binary).substr(0, size));
+    }
+    const std::string skewed = std::string(70000, 'e') + generate_random_string(3000, 4);
+    ok = ok && byte_histogram(skewed) == naive(skewed);
+    std::cout << "  [" << (ok ? "PASS" : "FAIL") << "] byte_histogram\n";
+    ok ? ++g_passed : ++g_failed;
+
+    // 以很小的块强制走多线程路径
+    bool parallel_ok = byte_histogram_parallel(binary, 4, 1000) == naive(binary) &&
+                       byte_histogram_parallel(skewed, 3, 4096) == naive(skewed);
+    std::cout << "  [" << (parallel_ok ? "PASS" : "FAIL") << "] byte_histogram_parallel\n";
+    parallel_ok ? ++g_passed : ++g_failed;
+}
+
+void test_bit_stream() {
+    std::cout << "\n=== Bit Stream Test ===\n";
+
+    // 随机长度的码字写入后按同样的长度读回
+    std::mt19937 rng(11);
+    std::vector<std::pair<std::uint32_t, unsigned>> values;
+    for (int i = 0; i < 20000; ++i) {
+        unsigned length = 1 + rng() % 32;
+        std::uint32_t value = length == 32 ? rng() : rng() & ((1u << length) - 1);
+        values.emplace_back(value, length);
+    }
+
+    std::vector<Byte> buffer;
+    BitWriter writer(buffer);
+    std::uint64_t total_bits = 0;
+    for (const auto& [value, length] : values) {
+        writer.write(value, length);
+        total_bits += length;
+    }
+    writer.finish();
+
+    bool ok = buffer.size() == (total_bits + 7) / 8;
+    BitReader reader(buffer.data(), buffer.data() + buffer.size());
+    for (const auto& [value, length] : values) {
+        if (reader.available() < length) {
+            reader.refill();
+        }
+        if (reader.peek(length) != value) {
+            ok = false;
+            break;
+        }
+        reader.consume(length);
+    }
+    ok = ok && reader.bits_consumed() == total_bits;
+
+    std::cout << "  [" << (ok ? "PASS" : "FAIL") << "] bit writer/reader roundtrip\n";
+    ok ? ++g_passed : ++g_failed;
+}
+
+void test_huffman_long_codes() {
+    std::cout << "\n=== Huffman Long Code Test ===\n";
+
+    // 斐波那契频率使 Huffman 树退化成链：Tree 格式的码长超过 2 * kPrimaryBits，覆盖多级子表；
+    // Canonical 格式的码长受 kMaxCodeLength 限制
+    std::string input;
+    std::array<std::size_t, 256> freq{};
+    std::uint64_t a = 1;
+    std::uint64_t b = 1;
+    for (int symbol = 0; symbol < 26; ++symbol) {
+        input.append(static_cast<std::size_t>(a), static_cast<char>('A' + symbol));
+        freq['A' + symbol] = static_cast<std::size_t>(a);
+        std::uint64_t next = a + b;
+        a = b;
+        b = next;
+    }
+    std::shuffle(input.begin(), input.end(), std::mt19937(5));
+
+    try {
+        HuffmanCompressor tree(HuffmanFormat::Tree);
+        auto compressed = tree.compress(input);
+        // Tree 流与 Canonical 流无法由内容区分，按容器版本选择解码器
+        auto decoder = create_decompressor(AlgorithmId::Huffman, tree.format_version());
+        bool ok = decoder->decompress(compressed) == input;
+        std::cout << "  [" << (ok ? "PASS" : "FAIL") << "] huffman tree format, deep codes\n";
+        ok ? ++g_passed : ++g_failed;
+    } catch (const std::exception& e) {
+        std::cout << "  [ERROR] huffman tree format: " << e.what() << "\n";
+        ++g_failed;
+    }
+    check_roundtrip("huffman", "fibonacci frequencies", input);
+
+    // package-merge：码长不超过上限且 Kraft 和恰好为 1
+    auto lengths = build_code_lengths(freq, HuffmanCompressor::kMaxCodeLength);
+    unsigned max_length = 0;
+    std::uint64_t kraft = 0;
+    for (std::uint8_t len : lengths) {
+        if (len > 0) {
+            max_length = std::max<unsigned>(max_length, len);
+            kraft += std::uint64_t{1} << (HuffmanCompressor::kMaxCodeLength - len);
+        }
+    }
+    bool limited = max_length == HuffmanCompressor::kMaxCodeLength &&
+                   kraft == (std::uint64_t{1} << HuffmanCompressor::kMaxCodeLength);
+    std::cout << "  [" << (limited ? "PASS" : "FAIL") << "] length-limited code, max length "
+              << max_length << "\n";
+    limited ? ++g_passed : ++g_failed;
+
+    // 小消息只传输码长表，头部比序列化整棵树更短
+    const std::string message = "hello, compressed world";
+    auto canonical_size = HuffmanCompressor().compress(message).size();
+    auto tree_size = HuffmanCompressor(HuffmanFormat::Tree).compress(message).size();
+    bool compact = canonical_size < tree_size;
+    std::cout << "  [" << (compact ? "PASS" : "FAIL") << "] small message canonical=" << canonical_size
+              << " tree=" << tree_size << "\n";
+    compact ? ++g_passed : ++g_failed;
+
+    // 把流头的原始长度改为 1 TiB：载荷不可能解出这么多符号，分配输出之前就应拒绝
+    const auto valid = HuffmanCompressor().compress(message);
+    const Byte* payload = valid.data() + 1;
+    read_varint(payload, valid.data() + valid.size());
+    std::vector<Byte> forged = {valid[0]};
+    write_varint(forged, std::uint64_t{1} << 40);
+    forged.insert(forged.end(), payload, valid.data() + valid.size());
+    bool forged_ok = false;
+    try {
+        HuffmanCompressor().decompress(forged);
+    } catch (const std::runtime_error& e) {
+        forged_ok = std::string(e.what()).find("exceeds payload") != std::string::npos;
+    } catch (const std::exception&) {
+    }
+    std::cout << "  [" << (forged_ok ? "PASS" : "FAIL") << "] forged canonical original length rejected\n";
+    forged_ok ? ++g_passed : ++g_failed;
+
+    // Tree 流头的 8 字节原始长度同样改为 1 TiB
+    auto forged_tree = HuffmanCompressor(HuffmanFormat::Tree).compress(message);
+    forged_tree[5] = 0x01;
+    forged_ok = false;
+    try {
+        HuffmanCompressor(HuffmanFormat::Tree).decompress(forged_tree);
+    } catch (const std::runtime_error& e) {
+        forged_ok = std::string(e.what()).find("exceeds payload") != std::string::npos;
+    } catch (const std::exception&) {
+    }
+    std::cout << "  [" << (forged_ok ? "PASS" : "FAIL") << "] forged tree original length rejected\n";
+    forged_ok ? ++g_passed : ++g_failed;
+}
+
+void test_huffman_four_streams() {
+    std::cout << "\n=== Huffman Four Stream Test ===\n";
+
+    // 阈值附近及段长不能整除的长度，四个段的长度各不相同
+    std::string text;
+    while (text.size() < 50000) {
+        text += "the quick brown fox jumps over the lazy dog " + std::to_string(text.size()) + "\n";
+    }
+
+    bool ok = true;
+    for (std::size_t size : {HuffmanCompressor::kFourStreamThreshold - 1,
+                             HuffmanCompressor::kFourStreamThreshold,
+                             HuffmanCompressor::kFourStreamThreshold + 1,
+                             HuffmanCompressor::kFourStreamThreshold + 3,
+                             std::size_t{49999}}) {
+        const std::string input = text.substr(0, size);
+        HuffmanCompressor huffman;
+        auto compressed = huffman.compress(input);
+        const bool expect_four = size >= HuffmanCompressor::kFourStreamThreshold;
+        if ((compressed[0] == 2) != expect_four || huffman.decompress(compressed) != input) {
+            std::cerr << "[FAIL] huffman four streams size=" << size << "\n";
+            ok = false;
+        }
+    }
+    std::cout << "  [" << (ok ? "PASS" : "FAIL") << "] four-stream layout\n";
+    ok ? ++g_passed : ++g_failed;
+
+    // 截断的流必须报错而不是越界读取
+    auto compressed = HuffmanCompressor().compress(text);
+    compressed.resize(compressed.size() / 2);
+    bool rejected = false;
+    try {
+        HuffmanCompressor().decompress(compressed);
+    } catch (const std::exception&) {
+        rejected = true;
+    }
+    std::cout << "  [" << (rejected ? "PASS" : "FAIL") << "] truncated four-stream input rejected\n";
+    rejected ? ++g_passed : ++g_failed;
+}
+
+void test_range_coder() {
+    std::cout << "\n=== Range Coder Test ===\n";
+
+    // 高度偏斜的遥测类数据：绝大多数为 0，Huffman 每符号至少 1 位，区间编码可低于 1 位
+    std::mt19937 rng(7);
+    std::string telemetry;
+    for (int i = 0; i < 100000; ++i) {
+        const unsigned r = rng() % 100;
+        telemetry.push_back(static_cast<char>(r < 92 ? 0 : (r < 97 ? 1 : r)));
+    }
+    RangeCompressor range;
+    HuffmanCompressor huffman;
+    auto range_data = range.compress(telemetry);
+    auto huffman_data = huffman.compress(telemetry);
+    bool ok = range.decompress(range_data) == telemetry &&
+              range_data.size() * 10 <= huffman_data.size() * 9;
+    std::cout << "  [" << (ok ? "PASS" : "FAIL") << "] skewed input: range " << range_data.size()
+              << " bytes vs huffman " << huffman_data.size() << " bytes\n";
+    ok ? ++g_passed : ++g_failed;
+
+    // 全部 256 个符号、触发多次频率减半的长输入
+    const std::string binary = generate_binary_data(300000);
+    std::vector<Byte> coded;
+    range_encode_bytes(coded, reinterpret_cast<const Byte*>(binary.data()), binary.size());
+    auto decoded = range_decode_bytes(coded.data(), coded.data() + coded.size(), binary.size());
+    ok = std::equal(decoded.begin(), decoded.end(), binary.begin(),
+                    [](Byte a, char b) { return a == static_cast<Byte>(b); });
+    std::cout << "  [" << (ok ? "PASS" : "FAIL") << "] full alphabet with rescaling\n";
+    ok ? ++g_passed : ++g_failed;
+
+    bool rejected = false;
+    try {
+        range_decode_bytes(coded.data(), coded.data() + coded.size() / 2, binary.size());
+    } catch (const std::exception&) {
+        rejected = true;
+    }
+    std::cout << "  [" << (rejected ? "PASS" : "FAIL") << "] truncated range data rejected\n";
+    rejected ? ++g_passed : ++g_failed;
+
+    // BWT 以区间编码作为 MTF 之后的熵编码阶段（格式版本 2），旧格式仍可解码
+    std::string text;
+    while (text.size() < 20000) {
+        text += "sensor=" + std::to_string(text.size() % 97) + " status=ok\n";
+    }
+    BwtCompressor bwt(CompressionLevel::Default, BwtFormat::MtfRange);
+    BwtCompressor bwt_mtf(CompressionLevel::Default, BwtFormat::Mtf);
+    auto bwt_range = bwt.compress(text);
+    auto bwt_plain = bwt_mtf.compress(text);
+    ok = bwt.format_version() == 2 && bwt_range.size() < bwt_plain.size() / 4 &&
+         bwt.decompress(bwt_range) == text &&
+         create_decompressor(AlgorithmId::Bwt, 1)->decompress(bwt_plain) == text;
+    std::cout << "  [" << (ok ? "PASS" : "FAIL") << "] bwt range stage: " << bwt_range.size()
+              << " bytes vs " << bwt_plain.size() << " bytes\n";
+    ok ? ++g_passed : ++g_failed;
+}
+
+void test_fse() {
+    std::cout << "\n=== FSE Test ===\n";
+
+    // 归一化计数之和必须等于表大小，出现过的符号至少为 1
+    bool ok = true;
+    for (const std::string& sample : {generate_binary_data(5000), generate_random_string(300), std::string("ab")}) {
+        const ByteHistogram histogram = byte_histogram(sample);
+        std::size_t symbols = 0;
+        for (std::size_t c : histogram) {
+            symbols += c != 0;
+        }
+        const unsigned table_log = fse_table_log(sample.size(), symbols);
+        const FseCounts counts = normalize_counts(histogram, sample.size(), table_log);
+        std::size_t sum = 0;
+        for (int b = 0; b < 256; ++b) {
+            sum += counts[b];
+            ok = ok && (histogram[b] == 0) == (counts[b] == 0);
+        }
+        ok = ok && sum == (std::size_t{1} << table_log);
+    }
+    std::cout << "  [" << (ok ? "PASS" : "FAIL") << "] normalized counts\n";
+    ok ? ++g_passed : ++g_failed;
+
+    // 偏斜分布上每符号可少于 1 位，压缩率接近区间编码、明显优于 Huffman
+    std::mt19937 rng(11);
+    std::string skewed;
+    for (int i = 0; i < 200000; ++i) {
+        const unsigned r = rng() % 100;
+        skewed.push_back(static_cast<char>(r < 90 ? 'a' : (r < 96 ? 'b' : 'c' + r % 8)));
+    }
+    FseCompressor fse;
+    auto fse_data = fse.compress(skewed);
+    auto huffman_data = HuffmanCompressor().compress(skewed);
+    auto range_data = RangeCompressor().compress(skewed);
+    ok = fse.decompress(fse_data) == skewed && fse_data.size() * 10 <= huffman_data.size() * 9 &&
+         fse_data.size() * 100 <= range_data.size() * 105;
+    std::cout << "  [" << (ok ? "PASS" : "FAIL") << "] skewed input: fse " << fse_data.size()
+              << " bytes, range " << range_data.size() << " bytes, huffman " << huffman_data.size()
+              << " bytes\n";
+    ok ? ++g_passed : ++g_failed;
+
+    // 多块输入：单一符号块、随机（原样存储）块与普通块混合
+    std::string mixed = std::string(FseCompressor::kBlockSize, 'z') +
+                        generate_binary_data(FseCompressor::kBlockSize) + skewed.substr(0, 1000);
+    ok = fse.decompress(fse.compress(mixed)) == mixed;
+    std::cout << "  [" << (ok ? "PASS" : "FAIL") << "] mixed block modes\n";
+    ok ? ++g_passed : ++g_failed;
+
+    fse_data.resize(fse_data.size() - 16);
+    bool rejected = false;
+    try {
+        fse.decompress(fse_data);
+    } catch (const std::exception&) {
+        rejected = true;
+    }
+    std::cout << "  [" << (rejected ? "PASS" : "FAIL") << "] truncated fse input rejected\n";
+    rejected ? ++g_passed : ++g_failed;
+
+    // 单一符号块的流头原始长度改为 1 TiB：两字节的载荷只够一块，分配输出之前就应拒绝
+    const auto single = fse.compress(std::string(10, 'z'));
+    std::vector<Byte> forged;
+    write_varint(forged, std::uint64_t{1} << 40);
+    forged.insert(forged.end(), single.begin() + 1, single.end());
+    rejected = false;
+    try {
+        fse.decompress(forged);
+    } catch (const std::runtime_error& e) {
+        rejected = std::string(e.what()).find("exceeds payload") != std::string::npos;
+    }
+    std::cout << "  [" << (rejected ? "PASS" : "FAIL") << "] forged fse original length rejected\n";
+    rejected ? ++g_passed : ++g_failed;
+}
+
+void test_fse_order1() {
+    std::cout << "\n=== FSE Order-1 Test ===\n";
+
+    // 随机挑选单词组成的文本：字节分布接近一般文本，但后一字节强烈依赖前一字节
+    const std::vector<std::string> words = {"compress", "stream", "block", "table", "state",
+                                            "symbol", "context", "entropy", "decode", "buffer"};
+    std::mt19937 rng(5);
+    std::string text;
+    while (text.size() < 300000) {
+        text += words[rng() % words.size()];
+        text += (rng() % 8 == 0) ? ".\n" : " ";
+    }
+
+    FseOrder1Compressor order1;
+    auto order1_data = order1.compress(text);
+    auto huffman_data = HuffmanCompressor().compress(text);
+    bool ok = order1.decompress(order1_data) == text && order1_data.size() * 10 <= huffman_data.size() * 8;
+    std::cout << "  [" << (ok ? "PASS" : "FAIL") << "] text: fse-o1 " << order1_data.size()
+              << " bytes vs huffman " << huffman_data.size() << " bytes\n";
+    ok ? ++g_passed : ++g_failed;
+
+    // 跨块输入：随机数据块原样存储，文本中少见的上下文走回退表
+    std::string mixed = text;
+    mixed += generate_binary_data(FseOrder1Compressor::kBlockSize);
+    mixed += generate_random_string(20000) + text.substr(0, 50000);
+    ok = order1.decompress(order1.compress(mixed)) == mixed;
+    std::cout << "  [" << (ok ? "PASS" : "FAIL") << "] multi-block with raw and fallback tables\n";
+    ok ? ++g_passed : ++g_failed;
+
+    order1_data.resize(order1_data.size() / 2);
+    bool rejected = false;
+    try {
+        order1.decompress(order1_data);
+    } catch (const std::exception&) {
+        rejected = true;
+    }
+    std::cout << "  [" << (rejected ? "PASS" : "FAIL") << "] truncated fse-o1 input rejected\n";
+    rejected ? ++g_passed : ++g_failed;
+
+    // 单块流的流头原始长度改为 1 TiB：载荷远不够那么多块，分配输出之前就应拒绝
+    const auto valid = order1.compress(text.substr(0, 5000));
+    const Byte* payload = valid.data();
+    read_varint(payload, valid.data() + valid.size());
+    std::vector<Byte> forged;
+    write_varint(forged, std::uint64_t{1} << 40);
+    forged.insert(forged.end(), payload, valid.data() + valid.size());
+    rejected = false;
+    try {
+        order1.decompress(forged);
+    } catch (const std::runtime_error& e) {
+        rejected = std::string(e.what()).find("exceeds payload") != std::string::npos;
+    }
+    std::cout << "  [" << (rejected ? "PASS" : "FAIL") << "] forged fse-o1 original length rejected\n";
+    rejected ? ++g_passed : ++g_failed;
+}
+
+void test_suffix_array() {
+    std::cout << "\n=== Suffix Array Test ===\n";
+
+    // 与直接比较的排序结果对照：小字母表随机串（大量重复子串）、周期串与全相同字节
+    std::vector<std::string> inputs;
+    std::mt19937 rng(11);
+    for (std::size_t length : {1u, 2u, 9u, 10u, 37u, 500u, 4000u}) {
+        std::string s;
+        for (std::size_t i = 0; i < length; ++i) {
+            s.push_back(static_cast<char>('a' + rng() % 3));
+        }
+        inputs.push_back(s);
+    }
+    inputs.push_back(generate_binary_data(3000));
+    inputs.push_back(std::string(777, 'z'));
+    std::string periodic;
+    for (int i = 0; i < 300; ++i) periodic += "abcab";
+    inputs.push_back(periodic);
+    inputs.push_back(periodic + "a");
+
+    bool sa_ok = true;
+    bool rotations_ok = true;
+    for (const auto& s : inputs) {
+        const auto* text = reinterpret_cast<const Byte*>(s.data());
+        const std::size_t n = s.size();
+
+        std::vector<std::int32_t> expected(n);
+        std::iota(expected.begin(), expected.end(), 0);
+        std::sort(expected.begin(), expected.end(), [&](std::int32_t a, std::int32_t b) {
+            return s.compare(a, std::string::npos, s, b, std::string::npos) < 0;
+        });
+        sa_ok = sa_ok && suffix_array(text, n) == expected;
+
+        std::iota(expected.begin(), expected.end(), 0);
+        std::stable_sort(expected.begin(), expected.end(), [&](std::int32_t a, std::int32_t b) {
+            return (s.substr(a) + s.substr(0, a)) < (s.substr(b) + s.substr(0, b));
+        });
+        rotations_ok = rotations_ok && sort_rotations(text, n) == expected;
+    }
+    std::cout << "  [" << (sa_ok ? "PASS" : "FAIL") << "] SA-IS matches naive suffix sort\n";
+    sa_ok ? ++g_passed : ++g_failed;
+    std::cout << "  [" << (rotations_ok ? "PASS" : "FAIL") << "] rotation order matches naive sort\n";
+    rotations_ok ? ++g_passed : ++g_failed;
+
+    // 高度重复的整块输入：旧的比较排序在这类输入上退化为 O(n^2 log n)
+    std::string repetitive;
+    while (repetitive.size() < 2 * BwtCompressor::kMinBlockSize) repetitive += "abcab";
+    std::string runs = std::string(50000, 'a') + "b" + std::string(70000, 'a');
+    check_roundtrip("bwt", "periodic-blocks", repetitive);
+    check_roundtrip("bwt", "long-runs", runs);
+}
+
+void test_bwt_zero_run_huffman() {
+    std::cout << "\n=== BWT Zero-Run Huffman Test ===\n";
+
+    // 版本 3：0 游程编码 + 多表 Huffman，文本上应优于区间编码阶段
+    std::string text;
+    std::mt19937 rng(21);
+    while (text.size() < 250000) {
+        text += "id=" + std::to_string(rng() % 5000) + " level=" + (rng() % 4 ? "info" : "warn") +
+                " msg=request handled in " + std::to_string(rng() % 300) + "ms\n";
+    }
+    BwtCompressor bwt(CompressionLevel::Default, BwtFormat::MtfHuffman);
+    BwtCompressor bwt_range(CompressionLevel::Default, BwtFormat::MtfRange);
+    auto huffman_data = bwt.compress(text);
+    auto range_data = bwt_range.compress(text);
+    bool ok = bwt.format_version() == 3 && huffman_data.size() < range_data.size() &&
+              bwt.decompress(huffman_data) == text &&
+              create_decompressor(AlgorithmId::Bwt, 2)->decompress(range_data) == text;
+    std::cout << "  [" << (ok ? "PASS" : "FAIL") << "] text: " << huffman_data.size()
+              << " bytes vs range stage " << range_data.size() << " bytes\n";
+    ok ? ++g_passed : ++g_failed;
+
+    // 整块相同字节（一个超长 0 游程）与全字节值随机数据（MTF 值 254/255 走转义）
+    std::string same(BwtCompressor::kLegacyMaxBlockSize + 123, 'q');
+    std::string binary = generate_binary_data(150000, 9);
+    auto same_data = bwt.compress(same);
+    ok = same_data.size() < 100 && bwt.decompress(same_data) == same &&
+         bwt.decompress(bwt.compress(binary)) == binary;
+    std::cout << "  [" << (ok ? "PASS" : "FAIL") << "] long zero run (" << same_data.size()
+              << " bytes) and escaped MTF values\n";
+    ok ? ++g_passed : ++g_failed;
+
+    bool rejected = false;
+    huffman_data.resize(huffman_data.size() - 40);
+    try {
+        bwt.decompress(huffman_data);
+    } catch (const std::exception&) {
+        rejected = true;
+    }
+    std::cout << "  [" << (rejected ? "PASS" : "FAIL") << "] truncated block rejected\n";
+    rejected ? ++g_passed : ++g_failed;
+}
+
+void test_bwt_mtf() {
+    std::cout << "\n=== BWT MTF Test ===\n";
+
+    // 版本 1 直接存储 MTF 输出："banana" 的 BWT 为 "nnbaaa"（primary_index 3）
+    BwtCompressor bwt_mtf(CompressionLevel::Default, BwtFormat::Mtf);
+    const std::vector<Byte> expected = {6, 0, 0, 0, 0, 0, 0, 0,
+                                        3, 0, 0, 0, 0, 0, 0, 0,
+                                        6, 0, 0, 0, 0, 0, 0, 0,
+                                        110, 0, 99, 99, 0, 0};
+    bool ok = bwt_mtf.compress("banana") == expected && bwt_mtf.decompress(expected) == "banana";
+    std::cout << "  [" << (ok ? "PASS" : "FAIL") << "] banana MTF stream\n";
+    ok ? ++g_passed : ++g_failed;
+
+    // 秩覆盖 0~255：按与上次出现的距离递增的顺序访问所有字节值
+    std::string all_ranks;
+    for (int round = 0; round < 40; ++round) {
+        for (int c = 0; c < 256; ++c) {
+            all_ranks.push_back(static_cast<char>((c * 7 + round) & 0xFF));
+            all_ranks.push_back(static_cast<char>((255 - c + round) & 0xFF));
+        }
+    }
+    ok = bwt_mtf.decompress(bwt_mtf.compress(all_ranks)) == all_ranks;
+    std::cout << "  [" << (ok ? "PASS" : "FAIL") << "] MTF roundtrip over all ranks\n";
+    ok ? ++g_passed : ++g_failed;
+}
+
+void test_bwt_large_blocks() {
+    std::cout << "\n=== BWT Large Block Test ===\n";
+
+    std::string text;
+    std::mt19937 rng(31);
+    while (text.size() < 700000) {
+        text += "host=web" + std::to_string(rng() % 40) + " path=/api/v" + std::to_string(rng() % 3) +
+                "/items/" + std::to_string(rng() % 20000) + " status=" + (rng() % 9 ? "200" : "404") + "\n";
+    }
+
+    // 版本 4：块头为 varint，块越大压缩率越高；旧格式仍可解码
+    BwtCompressor fastest(CompressionLevel::Fastest, BwtFormat::LargeBlock);
+    BwtCompressor large(CompressionLevel::Default, BwtFormat::LargeBlock);
+    BwtCompressor legacy(CompressionLevel::Default, BwtFormat::MtfHuffman);
+    auto small_data = fastest.compress(text);
+    auto large_data = large.compress(text);
+    auto legacy_data = legacy.compress(text);
+    bool ok = large.format_version() == 4 && large.block_size() >= 1024 * 1024 &&
+              fastest.block_size() == BwtCompressor::kMinBlockSize &&
+              large_data.size() < small_data.size() && small_data.size() < legacy_data.size() &&
+              large.decompress(large_data) == text && large.decompress(small_data) == text &&
+              create_decompressor(AlgorithmId::Bwt, 3)->decompress(legacy_data) == text;
+    std::cout << "  [" << (ok ? "PASS" : "FAIL") << "] 1 MB block " << large_data.size() << " bytes, 100 KB blocks "
+              << small_data.size() << " bytes, legacy " << legacy_data.size() << " bytes\n";
+    ok ? ++g_passed : ++g_failed;
+
+    // 显式块大小：范围外报错；内存估计随块大小线性增长
+    BwtCompressor explicit_size(300000);
+    ok = explicit_size.decompress(explicit_size.compress(text)) == text &&
+         BwtCompressor::memory_usage(2 * 300000).compress == 2 * explicit_size.memory_usage().compress &&
+         explicit_size.memory_usage().decompress >= 300000;
+    for (std::size_t bad : {std::size_t{1000}, BwtCompressor::kMaxBlockSize + 1}) {
+        try {
+            BwtCompressor invalid(bad);
+            ok = false;
+        } catch (const std::invalid_argument&) {
+        }
+    }
+    try {
+        BwtCompressor invalid(std::size_t{200000}, BwtFormat::MtfHuffman);
+        ok = false;
+    } catch (const std::invalid_argument&) {
+    }
+    std::cout << "  [" << (ok ? "PASS" : "FAIL") << "] explicit block size and memory estimate\n";
+    ok ? ++g_passed : ++g_failed;
+
+    // 按版本 4 的格式重新写出 [原始长度][primary_index][块大小][编码长度]，其后的编码数据取自正常的压缩结果；
+    // 块大小为 0、超过 kMaxBlockSize 或编码长度越过输入末尾时报错
+    const Byte* cursor = large_data.data();
+    const Byte* end = large_data.data() + large_data.size();
+    const std::uint64_t orig_len = read_varint(cursor, end);
+    const std::uint64_t primary_index = read_varint(cursor, end);
+    const std::uint64_t chunk_size = read_varint(cursor, end);
+    const std::uint64_t coded_size = read_varint(cursor, end);
+    auto block_header = [&](std::uint64_t length, std::uint64_t size, std::uint64_t coded) {
+        std::vector<Byte> stream;
+        write_varint(stream, length);
+        write_varint(stream, primary_index);
+        write_varint(stream, size);
+        write_varint(stream, coded);
+        stream.insert(stream.end(), cursor, end);
+        return stream;
+    };
+    auto rejected_with = [&](const std::vector<Byte>& stream, const std::string& message) {
+        try {
+            large.decompress(stream);
+        } catch (const std::exception& e) {
+            return std::string(e.what()).find(message) != std::string::npos;
+        }
+        return false;
+    };
+    const std::uint64_t oversized = BwtCompressor::kMaxBlockSize + 1;
+    const std::uint64_t remaining = static_cast<std::uint64_t>(end - cursor);
+    bool rejected = large.decompress(block_header(orig_len, chunk_size, coded_size)) == text &&
+                    rejected_with(block_header(orig_len, 0, coded_size), "invalid chunk size") &&
+                    rejected_with(block_header(oversized, oversized, coded_size), "invalid chunk size") &&
+                    rejected_with(block_header(orig_len, chunk_size, remaining + 1), "invalid chunk size");
+    std::cout << "  [" << (rejected ? "PASS" : "FAIL") << "] corrupted block header rejected\n";
+    rejected ? ++g_passed : ++g_failed;
+}
+
+void test_bwt_parallel_blocks() {
+    std::cout << "\n=== BWT Parallel Block Test ===\n";
+
+    std::string text;
+    std::mt19937 rng(41);
+    while (text.size() < 900000) {
+        text += "worker=" + std::to_string(rng() % 16) + " job=" + std::to_string(rng() % 100000) +
+                " state=" + (rng() % 5 ? "done" : "retry") + "\n";
+    }
+    text += generate_binary_data(50000, 3);
+
+    // 多线程的输出与单线程逐字节相同，解码同样按块并行
+    BwtCompressor serial(BwtCompressor::kMinBlockSize);
+    BwtCompressor parallel(BwtCompressor::kMinBlockSize);
+    serial.set_thread_count(1);
+    parallel.set_thread_count(4);
+    auto serial_data = serial.compress(text);
+    auto parallel_data = parallel.compress(text);
+    bool ok = parallel.thread_count() == 4 && serial_data == parallel_data &&
+              parallel.decompress(parallel_data) == text && serial.decompress(parallel_data) == text;
+    std::cout << "  [" << (ok ? "PASS" : "FAIL") << "] 4 threads match 1 thread over "
+              << (text.size() + BwtCompressor::kMinBlockSize - 1) / BwtCompressor::kMinBlockSize << " blocks\n";
+    ok ? ++g_passed : ++g_failed;
+
+    // 中间某块损坏：工作线程中的异常传回调用方
+    parallel_data[parallel_data.size() / 2] ^= 0x5A;
+    parallel_data[parallel_data.size() / 2 + 1] ^= 0xA5;
+    bool rejected = false;
+    try {
+        rejected = parallel.decompress(parallel_data) != text;
+    } catch (const std::exception&) {
+        rejected = true;
+    }
+    std::cout << "  [" << (rejected ? "PASS" : "FAIL") << "] corrupted block detected in worker thread\n";
+    rejected ? ++g_passed : ++g_failed;
+
+    // 自动线程数受内存预算限制：线程数 × 每线程工作内存不超过预算，至少 1 个线程；显式指定时不受限制
+    BwtCompressor best(CompressionLevel::Best);
+    const std::size_t per_thread = best.memory_usage().compress;
+    ok = best.memory_budget() == BwtCompressor::kDefaultMemoryBudget &&
+         best.thread_count() * per_thread <= BwtCompressor::kDefaultMemoryBudget;
+    best.set_memory_budget(3 * per_thread);
+    ok = ok && best.thread_count() >= 1 && best.thread_count() <= 3 &&
+         best.thread_count(best.memory_usage().decompress) >= best.thread_count();
+    best.set_memory_budget(0);
+    ok = ok && best.thread_count() == 1;
+    best.set_thread_count(8);
+    ok = ok && best.thread_count() == 8;
+    std::cout << "  [" << (ok ? "PASS" : "FAIL") << "] default thread count fits memory budget\n";
+    ok ? ++g_passed : ++g_failed;
+}
+
+void test_bwt_multi_cursor() {
+    std::cout << "\n=== BWT Multi-Cursor Inverse Test ===\n";
+
+    std::string text;
+    std::mt19937 rng(47);
+    while (text.size() < 2500000) {
+        text += "user=" + std::to_string(rng() % 500) + " action=" + (rng() % 3 ? "read" : "write") +
+                " bytes=" + std::to_string(rng() % 100000) + "\n";
+    }
+
+    // 默认格式（版本 5）：每块记录多个段起点，逆变换以多个游标交错还原；版本 4 流仍可解码
+    BwtCompressor current(CompressionLevel::Default);
+    BwtCompressor previous(CompressionLevel::Default, BwtFormat::LargeBlock);
+    auto current_data = current.compress(text);
+    auto previous_data = previous.compress(text);
+    bool ok = current.format_version() == 5 && current.decompress(current_data) == text &&
+              create_decompressor(AlgorithmId::Bwt, 4)->decompress(previous_data) == text &&
+              current_data.size() < previous_data.size() + 64;
+    std::cout << "  [" << (ok ? "PASS" : "FAIL") << "] v5 " << current_data.size() << " bytes, v4 "
+              << previous_data.size() << " bytes\n";
+    ok ? ++g_passed : ++g_failed;
+
+    // 小块与块尾的短块只记录一个起点；各段长度不整除时余下的字符也要还原
+    ok = true;
+    for (std::size_t size : {std::size_t{1}, std::size_t{7}, std::size_t{1000}, std::size_t{65536},
+                             std::size_t{65539}, std::size_t{100003}}) {
+        const std::string part = text.substr(0, size);
+        ok = ok && current.decompress(current.compress(part)) == part;
+    }
+    BwtCompressor fastest(CompressionLevel::Fastest);
+    ok = ok && fastest.decompress(fastest.compress(text)) == text;
+    std::cout << "  [" << (ok ? "PASS" : "FAIL") << "] short blocks and uneven segments\n";
+    ok ? ++g_passed : ++g_failed;
+
+    // 段数超出范围或起点越界时报错：按版本 5 的块头格式重新写出 [原始长度][段数][各段起点行]，
+    // 其后的 [块大小][编码长度][编码数据] 取自正常的压缩结果
+    const std::string block = text.substr(0, 100000);
+    const auto data = current.compress(block);
+    const Byte* cursor = data.data();
+    const Byte* end = data.data() + data.size();
+    read_varint(cursor, end);
+    const std::uint64_t cursors = read_varint(cursor, end);
+    for (std::uint64_t j = 0; j < cursors; ++j) {
+        read_varint(cursor, end);
+    }
+    auto corrupted_header = [&](std::uint64_t count, std::uint64_t row) {
+        std::vector<Byte> stream;
+        write_varint(stream, block.size());
+        write_varint(stream, count);
+        for (std::uint64_t j = 0; j < count; ++j) {
+            write_varint(stream, j + 1 < count ? 0 : row);
+        }
+        stream.insert(stream.end(), cursor, end);
+        return stream;
+    };
+    auto rejected_with = [&](const std::vector<Byte>& stream, const std::string& message) {
+        try {
+            current.decompress(stream);
+        } catch (const std::exception& e) {
+            return std::string(e.what()).find(message) != std::string::npos;
+        }
+        return false;
+    };
+    bool rejected = cursors == BwtCompressor::kDecodeCursors &&
+                    rejected_with(corrupted_header(BwtCompressor::kDecodeCursors + 1, 0), "invalid cursor count") &&
+                    rejected_with(corrupted_header(BwtCompressor::kDecodeCursors, block.size()),
+                                  "invalid primary index");
+    std::cout << "  [" << (rejected ? "PASS" : "FAIL") << "] corrupted cursor header rejected\n";
+    rejected ? ++g_passed : ++g_failed;
+}
+
 void test_container_support() {
     std::cout << "\n=== Container Format Test ===\n";
 
@@ -128,10 +1465,16 @@ void test_container_support() {
         try {
             auto packed = pack_container(info.id, original_size, payload);
             auto unpacked = unpack_container(packed);
+            auto versioned = unpack_container(pack_container(info.id, original_size, payload, 2));
 
             if (unpacked.algorithm == info.id &&
                 unpacked.original_size == original_size &&
-                unpacked.payload == payload) {
+                unpacked.payload == payload &&
+                unpacked.format_version == 1 &&
+                versioned.algorithm == info.id &&
+                versioned.original_size == original_size &&
+                versioned.payload == payload &&
+                versioned.format_version == 2) {
                 std::cout << "  [PASS] container_" << info.name << "\n";
                 ++g_passed;
             } else {
@@ -251,6 +1594,35 @@ int main() {
 
     // 并行压缩测试
     test_parallel_compressor();
+    test_parallel_baseline_streams();
+
+    // 匹配长度内核与 LZ77 哈希链深度测试
+    test_match_length();
+    test_lz_overlap_copy();
+    test_lz77_chain_depth();
+    test_lz77_wide_format();
+
+    // LZSS 各压缩级别测试
+    test_lzss_levels();
+    test_lzss_parse_strategies();
+    test_lzw_format();
+    test_lzh_hybrid();
+    test_histogram();
+    test_bit_stream();
+    test_huffman_long_codes();
+    test_huffman_four_streams();
+    test_range_coder();
+    test_fse();
+    test_fse_order1();
+    test_suffix_array();
+    test_bwt_zero_run_huffman();
+    test_bwt_mtf();
+    test_bwt_large_blocks();
+    test_bwt_parallel_blocks();
+    test_bwt_multi_cursor();
+
+    // 所有算法的压缩级别测试
+    test_compression_levels();
 
     // 容器格式与API文件往返测试
     test_container_support();